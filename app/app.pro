@@ -0,0 +1,75 @@
+QT += core gui widgets network
+
+CONFIG += c++14
+
+TARGET = sudoqu
+TEMPLATE = app
+
+INCLUDEPATH += ../src
+
+SOURCES +=  ../src/main.cpp\
+            ../src/mainwindow.cpp \
+            ../src/gameframe.cpp \
+            ../src/game.cpp \
+            ../src/sudoku.cpp \
+            ../src/solver.cpp \
+            ../src/grader.cpp \
+            ../src/units.cpp \
+            ../src/isomorph.cpp \
+            ../src/solutioncache.cpp \
+            ../src/random.cpp \
+            ../src/generator.cpp \
+            ../src/connectdialog.cpp \
+            ../src/chatbox.cpp \
+            ../src/settings.cpp \
+            ../src/colortheme.cpp \
+            ../src/colorthemedialog.cpp \
+            ../src/metrics.cpp \
+            ../src/journal.cpp \
+            ../src/recorder.cpp \
+            ../src/puzzlebank.cpp \
+            ../src/rendercache.cpp \
+            ../src/statusmodel.cpp \
+            ../src/chatmodel.cpp
+
+HEADERS  += ../src/mainwindow.h \
+            ../src/gameframe.h \
+            ../src/game.h \
+            ../src/sudoku.h \
+            ../src/solver.h \
+            ../src/grader.h \
+            ../src/units.h \
+            ../src/isomorph.h \
+            ../src/solutioncache.h \
+            ../src/random.h \
+            ../src/generator.h \
+            ../src/connectdialog.h \
+            ../src/chatbox.h \
+            ../src/settings.h \
+            ../src/colortheme.h \
+            ../src/colorthemedialog.h \
+            ../src/metrics.h \
+            ../src/journal.h \
+            ../src/recorder.h \
+            ../src/puzzlebank.h \
+            ../src/rendercache.h \
+            ../src/statusmodel.h \
+            ../src/chatmodel.h
+
+FORMS    += ../ui/mainwindow.ui \
+            ../ui/connectdialog.ui \
+            ../ui/colorthemedialog.ui
+
+LIBS += -L$$OUT_PWD/../client -lsudoqu-client
+PRE_TARGETDEPS += $$OUT_PWD/../client/libsudoqu-client.a
+
+VERSION = "0.2.2"
+
+DEFINES += VERSION=\\\"$$VERSION\\\"
+
+CONFIG(debug, debug|release){
+    DEFINES += DEBUG
+}
+
+CONFIG += link_pkgconfig
+PKGCONFIG += qqwing
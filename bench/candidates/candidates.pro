@@ -0,0 +1,34 @@
+QT += core
+QT -= gui
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+TARGET = sudoqu-bench-candidates
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+SOURCES +=  main.cpp \
+            ../../src/candidates.cpp \
+            ../../src/sudoku.cpp \
+            ../../src/solver.cpp \
+            ../../src/grader.cpp \
+            ../../src/units.cpp \
+            ../../src/isomorph.cpp \
+            ../../src/solutioncache.cpp \
+            ../../src/random.cpp \
+            ../../src/generator.cpp
+
+HEADERS  += ../../src/candidates.h \
+            ../../src/sudoku.h \
+            ../../src/solver.h \
+            ../../src/grader.h \
+            ../../src/units.h \
+            ../../src/isomorph.h \
+            ../../src/solutioncache.h \
+            ../../src/random.h \
+            ../../src/generator.h
+
+CONFIG += link_pkgconfig
+PKGCONFIG += qqwing
@@ -0,0 +1,185 @@
+/*
+ * main.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * sudoqu-bench-candidates: scans a corpus of boards with each candidate kernel the
+ * processor supports, checks they agree with the scalar one, and reports the time per board.
+ */
+
+#include "candidates.h"
+#include "random.h"
+#include "sudoku.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Sudoqu;
+
+namespace {
+using Board = std::array<std::uint8_t, 81>;
+
+/**
+ * @brief every run scans the same boards
+ */
+const std::uint64_t SEED = 1;
+
+bool parse(const char *line, Board &board) {
+    for (size_t pos = 0; pos < board.size(); ++pos) {
+        char c = line[pos];
+        if (c >= '1' && c <= '9') {
+            board[pos] = static_cast<std::uint8_t>(c - '0');
+        } else if (c == '0' || c == '.') {
+            board[pos] = 0;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief adds a puzzle, and the puzzle a third and two thirds of the way to its solution
+ */
+void addBoards(const std::vector<int> &puzzle, const std::vector<int> &solution, Random &random,
+               std::vector<Board> &boards) {
+    for (std::uint32_t filled = 0; filled < 3; ++filled) {
+        Board board;
+        for (size_t pos = 0; pos < board.size(); ++pos) {
+            bool fill = puzzle[pos] == 0 && !solution.empty() && random.below(3) < filled;
+            board[pos] = static_cast<std::uint8_t>(fill ? solution[pos] : puzzle[pos]);
+        }
+        boards.push_back(board);
+    }
+}
+
+bool same(const CandidateScan &a, const CandidateScan &b) {
+    return a.valid == b.valid && !std::memcmp(a.candidates, b.candidates, sizeof(a.candidates)) &&
+           !std::memcmp(a.naked, b.naked, sizeof(a.naked)) && !std::memcmp(a.hidden, b.hidden, sizeof(a.hidden));
+}
+
+/**
+ * @return nanoseconds per board
+ */
+double measure(CandidateKernel::Implementation implementation, const std::vector<Board> &boards, int rounds,
+               unsigned &checksum) {
+    CandidateScan scan;
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < rounds; ++round) {
+        for (const Board &board : boards) {
+            CandidateKernel::scan(board, scan, implementation);
+            // keeps the scans from being optimized away
+            checksum += scan.valid + scan.naked[4][5] + scan.hidden[8][9];
+        }
+    }
+    return static_cast<double>(timer.nsecsElapsed()) / rounds / static_cast<double>(boards.size());
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sudoqu-bench-candidates");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the time taken to compute the candidates and singles of a board");
+    parser.addHelpOption();
+
+    QCommandLineOption puzzles(QStringList() << "p" << "puzzles", "Generate <n> puzzles when no corpus is given.",
+                               "n", "1000");
+    QCommandLineOption rounds(QStringList() << "r" << "rounds", "Scan the corpus <n> times per kernel.", "n", "100");
+    parser.addOption(puzzles);
+    parser.addOption(rounds);
+    parser.addPositionalArgument("corpus", "Puzzles, one per line, as written by sudoqu-puzzles.", "[corpus]");
+    parser.process(app);
+
+    Random random(SEED);
+    std::vector<Board> boards;
+
+    if (!parser.positionalArguments().isEmpty()) {
+        QString path = parser.positionalArguments().first();
+        std::FILE *in = std::fopen(qPrintable(path), "r");
+        if (in == nullptr) {
+            std::fprintf(stderr, "Could not open %s\n", qPrintable(path));
+            return 1;
+        }
+        char line[512];
+        Board board;
+        while (std::fgets(line, sizeof(line), in)) {
+            if (std::strlen(line) >= board.size() && parse(line, board)) {
+                std::vector<int> puzzle(board.begin(), board.end());
+                Sudoku sudoku;
+                sudoku.setBoard(puzzle);
+                addBoards(puzzle, sudoku.getSolution(), random, boards);
+            }
+        }
+        std::fclose(in);
+    } else {
+        Sudoku sudoku(SEED);
+        int count = std::max(1, parser.value(puzzles).toInt());
+        for (int i = 0; i < count; ++i) {
+            sudoku.generate(static_cast<SB::Difficulty>(SB::SIMPLE + i % 4));
+            addBoards(sudoku.getPuzzle(), sudoku.getSolution(), random, boards);
+        }
+    }
+
+    if (boards.empty()) {
+        std::fprintf(stderr, "No puzzles to scan\n");
+        return 1;
+    }
+
+    std::vector<CandidateKernel::Implementation> kernels;
+    for (auto kernel : {CandidateKernel::SCALAR, CandidateKernel::SSE41, CandidateKernel::AVX2}) {
+        if (CandidateKernel::isSupported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+
+    CandidateScan expected, scan;
+    for (const Board &board : boards) {
+        CandidateKernel::scan(board, expected, CandidateKernel::SCALAR);
+        for (auto kernel : kernels) {
+            CandidateKernel::scan(board, scan, kernel);
+            if (!same(expected, scan)) {
+                std::fprintf(stderr, "%s does not agree with the scalar kernel\n", CandidateKernel::name(kernel));
+                return 1;
+            }
+        }
+    }
+
+    int count = std::max(1, parser.value(rounds).toInt());
+    unsigned checksum = 0;
+    double scalar = 0;
+
+    std::printf("%zu boards, %d rounds\n", boards.size(), count);
+    for (auto kernel : kernels) {
+        double nanos = measure(kernel, boards, count, checksum);
+        if (kernel == CandidateKernel::SCALAR) {
+            scalar = nanos;
+        }
+        std::printf("%-8s %8.1f ns/board %6.2fx\n", CandidateKernel::name(kernel), nanos, scalar / nanos);
+    }
+    std::printf("checksum %u\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * main.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * sudoqu-bench-render: paints a busy board into an image, without a display, and reports
+ * the time and the number of allocations per frame with and without the render cache.
+ */
+
+#include "gameframe.h"
+#include "sudoku.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace Sudoqu;
+
+namespace {
+std::atomic<unsigned long> allocations(0);
+
+/**
+ * @brief every run paints the same board
+ */
+const std::uint64_t SEED = 1;
+}
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+struct Result {
+    double micros;
+    double allocations;
+};
+
+/**
+ * @brief paints the frame a number of times
+ * @return microseconds per frame, and calls to operator new per frame made by paintBoard
+ */
+Result measure(GameFrame &frame, int frames, const QRegion &region) {
+    QImage image(frame.size(), QImage::Format_ARGB32_Premultiplied);
+    QElapsedTimer timer;
+    unsigned long allocated = 0;
+
+    // clipped like the widget's own paint events, the first paint builds the cache
+    for (int i = -1; i < frames; ++i) {
+        if (i == 0) {
+            timer.start();
+            allocated = 0;
+        }
+        QPainter painter(&image);
+        painter.setClipRegion(region);
+
+        unsigned long before = allocations;
+        frame.paintBoard(painter, region);
+        allocated += allocations - before;
+    }
+    return {timer.nsecsElapsed() / 1000.0 / frames, static_cast<double>(allocated) / frames};
+}
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sudoqu-bench-render");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the time taken to paint the Sudoqu board");
+    parser.addHelpOption();
+
+    QCommandLineOption frames(QStringList() << "n" << "frames", "Paint <n> frames per measure.", "n", "1000");
+    QCommandLineOption size(QStringList() << "s" << "size", "Paint a board of <size> pixels.", "size", "630");
+    parser.addOption(frames);
+    parser.addOption(size);
+    parser.process(app);
+
+    int count = std::max(1, parser.value(frames).toInt());
+    int pixels = std::max(90, parser.value(size).toInt());
+
+    Sudoku sudoku(SEED);
+    sudoku.generate(SB::INTERMEDIATE);
+    std::vector<int> given = sudoku.getPuzzle();
+    std::vector<int> board = given;
+    const std::vector<int> &solution = sudoku.getSolution();
+
+    GameFrame frame;
+    frame.resize(pixels, pixels);
+    frame.newBoard(given, board, COOP);
+    frame.setNotesEnabled(true);
+
+    // fill half the empty squares, and take notes in the others
+    int empty = 0;
+    for (int pos = 0; pos < 81; ++pos) {
+        if (given[static_cast<size_t>(pos)] > 0) {
+            continue;
+        }
+        if (empty++ % 2 == 0) {
+            frame.setAt(pos, solution[static_cast<size_t>(pos)]);
+        } else {
+            // notes 1, 3, 5, 7 and 9
+            frame.receivedNotes(pos, 0x155);
+        }
+    }
+    frame.otherPlayerFocus(2, 40);
+    frame.otherPlayerFocus(3, 72);
+
+    int cell = pixels / 9;
+    QRegion whole(frame.rect());
+    QRegion square(QRect(4 * cell, 4 * cell, cell, cell).adjusted(-3, -3, 3, 3));
+
+    std::printf("%d frames of %dx%d pixels\n", count, pixels, pixels);
+    for (bool cached : {false, true}) {
+        frame.setRenderCacheEnabled(cached);
+        Result full = measure(frame, count, whole);
+        Result one = measure(frame, count, square);
+        std::printf("%-10s full board: %8.1f us/frame %7.1f allocs/frame\n", cached ? "cache" : "no cache", full.micros,
+                    full.allocations);
+        std::printf("%-10s one square: %8.1f us/frame %7.1f allocs/frame\n", "", one.micros, one.allocations);
+    }
+
+    return 0;
+}
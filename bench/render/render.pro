@@ -0,0 +1,39 @@
+QT += core gui widgets
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+TARGET = sudoqu-bench-render
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+SOURCES +=  main.cpp \
+            ../../src/gameframe.cpp \
+            ../../src/sudoku.cpp \
+            ../../src/solver.cpp \
+            ../../src/grader.cpp \
+            ../../src/units.cpp \
+            ../../src/isomorph.cpp \
+            ../../src/solutioncache.cpp \
+            ../../src/random.cpp \
+            ../../src/generator.cpp \
+            ../../src/colortheme.cpp \
+            ../../src/rendercache.cpp
+
+HEADERS  += ../../src/gameframe.h \
+            ../../src/sudoku.h \
+            ../../src/solver.h \
+            ../../src/grader.h \
+            ../../src/units.h \
+            ../../src/isomorph.h \
+            ../../src/solutioncache.h \
+            ../../src/random.h \
+            ../../src/generator.h \
+            ../../src/cells.h \
+            ../../src/constants.h \
+            ../../src/colortheme.h \
+            ../../src/rendercache.h
+
+CONFIG += link_pkgconfig
+PKGCONFIG += qqwing
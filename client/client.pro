@@ -0,0 +1,21 @@
+QT += core network
+QT -= gui
+
+CONFIG += c++14 staticlib
+
+TARGET = sudoqu-client
+TEMPLATE = lib
+
+INCLUDEPATH += ../src
+
+SOURCES +=  ../src/player.cpp \
+            ../src/network.cpp \
+            ../src/boardsync.cpp \
+            ../src/random.cpp
+
+HEADERS  += ../src/player.h \
+            ../src/network.h \
+            ../src/boardsync.h \
+            ../src/cells.h \
+            ../src/random.h \
+            ../src/constants.h
@@ -0,0 +1,91 @@
+/*
+ * boardsync.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "boardsync.h"
+
+namespace Sudoqu {
+
+void BoardSync::reset(const Cells &b, std::uint64_t r) {
+    confirmed = b;
+    board = b;
+    pending.clear();
+    revision = r;
+}
+
+std::uint64_t BoardSync::localMoves(const CellChanges &cells) {
+    apply(board, cells);
+    pending.push_back({++last_seq, cells});
+    return last_seq;
+}
+
+CellChanges BoardSync::remoteMoves(std::uint64_t r, const CellChanges &cells, std::uint64_t acknowledged) {
+    CellChanges changed;
+
+    // already part of the board, e.g. sent again after resuming a session
+    if (r <= revision) {
+        return changed;
+    }
+    revision = r;
+    apply(confirmed, cells);
+
+    while (!pending.empty() && pending.front().seq <= acknowledged) {
+        pending.pop_front();
+    }
+
+    Cells next = confirmed;
+    for (auto &moves : pending) {
+        apply(next, moves.cells);
+    }
+
+    for (int pos = 0; pos < 81; ++pos) {
+        if (board[static_cast<size_t>(pos)] != next[static_cast<size_t>(pos)]) {
+            changed.set(pos, next[static_cast<size_t>(pos)]);
+        }
+    }
+    board = next;
+    return changed;
+}
+
+void BoardSync::acknowledge(std::uint64_t acknowledged) {
+    // the board shown does not change, these moves move from pending to confirmed
+    while (!pending.empty() && pending.front().seq <= acknowledged) {
+        apply(confirmed, pending.front().cells);
+        pending.pop_front();
+    }
+}
+
+const Cells &BoardSync::getBoard() const {
+    return board;
+}
+
+std::uint64_t BoardSync::getRevision() const {
+    return revision;
+}
+
+const std::deque<BoardSync::Pending> &BoardSync::getPending() const {
+    return pending;
+}
+
+void BoardSync::apply(Cells &target, const CellChanges &cells) {
+    for (size_t pos = 0; pos < target.size(); ++pos) {
+        if (cells.changed.test(pos)) {
+            target[pos] = cells.values[pos];
+        }
+    }
+}
+}
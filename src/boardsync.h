@@ -0,0 +1,117 @@
+/*
+ * boardsync.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_BOARDSYNC_H
+#define SUDOQU_BOARDSYNC_H
+
+#include "cells.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace Sudoqu {
+
+/**
+ * @class BoardSync
+ * @brief Client side copy of a coop board, reconciling our own moves with the server's order
+ *
+ * The server numbers every change to a team's board with a revision, and echoes our moves
+ * back with the sequence number we gave them. The board shown to the player is the last
+ * board confirmed by the server with our unacknowledged moves applied on top, so a teammate
+ * writing in the same square is overridden by our move until the server has ordered both.
+ */
+class BoardSync {
+public:
+    /**
+     * @brief a batch of moves sent to the server and not acknowledged yet
+     */
+    struct Pending {
+        std::uint64_t seq;
+        CellChanges cells;
+    };
+
+    /**
+     * @brief replaces the board with one sent by the server, dropping our pending moves
+     * @param board the board
+     * @param revision its revision
+     */
+    void reset(const Cells &, std::uint64_t);
+
+    /**
+     * @brief records moves made by the player, already shown on the board
+     * @param cells the new values
+     * @return the sequence number of these moves, to send with them
+     */
+    std::uint64_t localMoves(const CellChanges &);
+
+    /**
+     * @brief applies moves ordered by the server
+     * @param revision the revision of the board after these moves
+     * @param cells the new values
+     * @param acknowledged the last sequence number of ours included in these moves, 0 if they are not ours
+     * @return the squares whose value as shown to the player changed
+     */
+    CellChanges remoteMoves(std::uint64_t, const CellChanges &, std::uint64_t = 0);
+
+    /**
+     * @brief our moves the server applied but whose echo we did not receive, e.g. before resuming a session
+     * @param acknowledged the last sequence number of ours the server applied
+     */
+    void acknowledge(std::uint64_t);
+
+    /**
+     * @return the board as shown to the player
+     */
+    const Cells &getBoard() const;
+
+    /**
+     * @return the last revision received from the server
+     */
+    std::uint64_t getRevision() const;
+
+    /**
+     * @return our moves not acknowledged yet, oldest first
+     */
+    const std::deque<Pending> &getPending() const;
+
+private:
+    /**
+     * @brief the board as last confirmed by the server
+     */
+    Cells confirmed{};
+
+    /**
+     * @brief the confirmed board with the pending moves applied
+     */
+    Cells board{};
+
+    std::deque<Pending> pending;
+
+    std::uint64_t revision = 0;
+
+    /**
+     * @brief never reset, so an echo from a previous board cannot acknowledge a new move
+     */
+    std::uint64_t last_seq = 0;
+
+    static void apply(Cells &, const CellChanges &);
+};
+}
+
+#endif
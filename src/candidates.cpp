@@ -0,0 +1,432 @@
+/*
+ * candidates.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "candidates.h"
+#include "units.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUDOQU_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Sudoqu {
+
+namespace {
+using ScanFunction = void (*)(const std::array<std::uint8_t, 81> &, CandidateScan &);
+
+void scanScalar(const std::array<std::uint8_t, 81> &cells, CandidateScan &scan) {
+    const BoardUnits &tables = boardUnits();
+
+    // rows, then columns, then boxes, as in BoardUnits::units
+    std::uint16_t used[27] = {};
+    for (int pos = 0; pos < 81; ++pos) {
+        if (cells[static_cast<size_t>(pos)]) {
+            std::uint16_t bit = digitBit(cells[static_cast<size_t>(pos)]);
+            used[tables.row[pos]] |= bit;
+            used[9 + tables.col[pos]] |= bit;
+            used[18 + tables.box[pos]] |= bit;
+        }
+    }
+
+    std::memset(&scan, 0, sizeof(scan));
+    scan.valid = true;
+
+    std::uint16_t candidates[81];
+    for (int pos = 0; pos < 81; ++pos) {
+        candidates[pos] = 0;
+        if (!cells[static_cast<size_t>(pos)]) {
+            candidates[pos] = ALL_DIGITS & ~(used[tables.row[pos]] | used[9 + tables.col[pos]] |
+                                             used[18 + tables.box[pos]]);
+            scan.valid = scan.valid && candidates[pos] != 0;
+        }
+    }
+
+    // a digit is a hidden single where it is a candidate once in the unit
+    std::uint16_t once[27];
+    for (int unit = 0; unit < 27; ++unit) {
+        std::uint16_t seen = 0, twice = 0;
+        for (int pos : tables.units[unit]) {
+            twice |= seen & candidates[pos];
+            seen |= candidates[pos];
+        }
+        once[unit] = seen & ~twice;
+        scan.valid = scan.valid && (seen | used[unit]) == ALL_DIGITS;
+    }
+
+    for (int pos = 0; pos < 81; ++pos) {
+        std::uint16_t candidate = candidates[pos];
+        int row = pos / 9, lane = CandidateScan::lane(pos);
+        scan.candidates[row][lane] = candidate;
+        scan.naked[row][lane] = candidate && !(candidate & (candidate - 1)) ? candidate : 0;
+        scan.hidden[row][lane] =
+            candidate & (once[tables.row[pos]] | once[9 + tables.col[pos]] | once[18 + tables.box[pos]]);
+    }
+}
+
+#ifdef SUDOQU_X86_KERNELS
+
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+/**
+ * @brief loads a row of the board as bytes, each column moved to its lane, padding lanes 0
+ */
+TARGET_SSE41 inline __m128i loadRow(const std::array<std::uint8_t, 81> &cells, int row) {
+    if (row < 8) {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&cells[row * 9])),
+                                _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, -1, -1, -1, -1));
+    }
+    // the last row is loaded from the end of the board, to not read past it
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&cells[65])),
+                            _mm_setr_epi8(7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1, -1, -1, -1, -1));
+}
+
+/**
+ * @brief the low and high byte of the bit of each digit, 0 for an empty square
+ */
+TARGET_SSE41 inline void digitBytes(__m128i values, __m128i &low, __m128i &high) {
+    low = _mm_shuffle_epi8(_mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0), values);
+    high = _mm_shuffle_epi8(_mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0), values);
+}
+
+/**
+ * @brief how many times each digit was seen in a set of squares: at least once, at least twice
+ */
+struct Count128 {
+    __m128i seen;
+    __m128i twice;
+};
+
+struct Count256 {
+    __m256i seen;
+    __m256i twice;
+};
+
+TARGET_SSE41 inline Count128 combine(const Count128 &a, const Count128 &b) {
+    return {_mm_or_si128(a.seen, b.seen),
+            _mm_or_si128(_mm_or_si128(a.twice, b.twice), _mm_and_si128(a.seen, b.seen))};
+}
+
+/**
+ * @brief moves each lane to the previous one within its group of four
+ */
+TARGET_SSE41 inline __m128i rotateGroup(__m128i x) {
+    return _mm_shuffle_epi8(x, _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9));
+}
+
+TARGET_SSE41 inline __m128i swapPairs(__m128i x) {
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+TARGET_SSE41 inline __m128i swapHalves(__m128i x) {
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+/**
+ * @brief combines the lanes of each group of four: the box of each lane
+ */
+TARGET_SSE41 inline __m128i foldGroup(__m128i x) {
+    x = _mm_or_si128(x, rotateGroup(x));
+    return _mm_or_si128(x, swapPairs(x));
+}
+
+TARGET_SSE41 inline Count128 foldGroup(Count128 c) {
+    c = combine(c, {rotateGroup(c.seen), rotateGroup(c.twice)});
+    return combine(c, {swapPairs(c.seen), swapPairs(c.twice)});
+}
+
+/**
+ * @brief with SSE, a row is split in two registers: lanes 0 to 7 and lanes 8 to 15
+ */
+TARGET_SSE41 void scanSse41(const std::array<std::uint8_t, 81> &cells, CandidateScan &scan) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i digits[2] = {_mm_setr_epi16(0x1ff, 0x1ff, 0x1ff, 0, 0x1ff, 0x1ff, 0x1ff, 0),
+                               _mm_setr_epi16(0x1ff, 0x1ff, 0x1ff, 0, 0, 0, 0, 0)};
+
+    __m128i bits[9][2];
+    for (int row = 0; row < 9; ++row) {
+        __m128i low, high;
+        digitBytes(loadRow(cells, row), low, high);
+        bits[row][0] = _mm_or_si128(_mm_cvtepu8_epi16(low), _mm_slli_epi16(_mm_cvtepu8_epi16(high), 8));
+        bits[row][1] = _mm_or_si128(_mm_cvtepu8_epi16(_mm_srli_si128(low, 8)),
+                                    _mm_slli_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(high, 8)), 8));
+    }
+
+    __m128i colUsed[2] = {zero, zero};
+    __m128i boxUsed[3][2];
+    for (int h = 0; h < 2; ++h) {
+        for (int band = 0; band < 3; ++band) {
+            __m128i used = _mm_or_si128(_mm_or_si128(bits[band * 3][h], bits[band * 3 + 1][h]), bits[band * 3 + 2][h]);
+            colUsed[h] = _mm_or_si128(colUsed[h], used);
+            boxUsed[band][h] = foldGroup(used);
+        }
+    }
+
+    __m128i bad = zero;
+    __m128i candidates[9][2];
+    for (int row = 0; row < 9; ++row) {
+        __m128i rowUsed = foldGroup(_mm_or_si128(bits[row][0], bits[row][1]));
+        rowUsed = _mm_or_si128(rowUsed, swapHalves(rowUsed));
+
+        for (int h = 0; h < 2; ++h) {
+            __m128i empty = _mm_and_si128(_mm_cmpeq_epi16(bits[row][h], zero), digits[h]);
+            __m128i used = _mm_or_si128(_mm_or_si128(rowUsed, colUsed[h]), boxUsed[row / 3][h]);
+            __m128i candidate = _mm_andnot_si128(used, empty);
+            __m128i none = _mm_cmpeq_epi16(candidate, zero);
+            bad = _mm_or_si128(bad, _mm_and_si128(empty, none));
+
+            __m128i single = _mm_cmpeq_epi16(_mm_and_si128(candidate, _mm_sub_epi16(candidate, one)), zero);
+            candidates[row][h] = candidate;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&scan.candidates[row][h * 8]), candidate);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&scan.naked[row][h * 8]),
+                             _mm_and_si128(candidate, _mm_andnot_si128(none, single)));
+        }
+    }
+
+    // a digit is a hidden single where it is a candidate once in the unit
+    __m128i colOnce[2];
+    __m128i boxOnce[3][2];
+    for (int h = 0; h < 2; ++h) {
+        Count128 col = {zero, zero};
+        for (int band = 0; band < 3; ++band) {
+            Count128 box = {candidates[band * 3][h], zero};
+            box = combine(box, {candidates[band * 3 + 1][h], zero});
+            box = combine(box, {candidates[band * 3 + 2][h], zero});
+            col = combine(col, box);
+
+            box = foldGroup(box);
+            boxOnce[band][h] = _mm_andnot_si128(box.twice, box.seen);
+            bad = _mm_or_si128(bad, _mm_andnot_si128(_mm_or_si128(box.seen, boxUsed[band][h]), digits[h]));
+        }
+        colOnce[h] = _mm_andnot_si128(col.twice, col.seen);
+        bad = _mm_or_si128(bad, _mm_andnot_si128(_mm_or_si128(col.seen, colUsed[h]), digits[h]));
+    }
+
+    for (int row = 0; row < 9; ++row) {
+        Count128 count = combine({candidates[row][0], zero}, {candidates[row][1], zero});
+        count = foldGroup(count);
+        count = combine(count, {swapHalves(count.seen), swapHalves(count.twice)});
+        __m128i rowOnce = _mm_andnot_si128(count.twice, count.seen);
+
+        // every digit is either placed in the row or still possible somewhere in it
+        __m128i rowUsed = foldGroup(_mm_or_si128(bits[row][0], bits[row][1]));
+        rowUsed = _mm_or_si128(rowUsed, swapHalves(rowUsed));
+        bad = _mm_or_si128(bad, _mm_andnot_si128(_mm_or_si128(count.seen, rowUsed), digits[0]));
+
+        for (int h = 0; h < 2; ++h) {
+            __m128i once = _mm_or_si128(_mm_or_si128(rowOnce, colOnce[h]), boxOnce[row / 3][h]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&scan.hidden[row][h * 8]),
+                             _mm_and_si128(candidates[row][h], once));
+        }
+    }
+
+    scan.valid = _mm_testz_si128(bad, bad);
+}
+
+TARGET_AVX2 inline Count256 combine(const Count256 &a, const Count256 &b) {
+    return {_mm256_or_si256(a.seen, b.seen),
+            _mm256_or_si256(_mm256_or_si256(a.twice, b.twice), _mm256_and_si256(a.seen, b.seen))};
+}
+
+TARGET_AVX2 inline __m256i rotateGroup(__m256i x) {
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, 2, 3, 4, 5,
+                                                   6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9));
+}
+
+TARGET_AVX2 inline __m256i swapPairs(__m256i x) {
+    return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/**
+ * @brief moves each group of four lanes to the previous one
+ */
+TARGET_AVX2 inline __m256i rotateGroups(__m256i x) {
+    return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+TARGET_AVX2 inline __m256i rotateGroups2(__m256i x) {
+    return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+TARGET_AVX2 inline __m256i foldGroup(__m256i x) {
+    x = _mm256_or_si256(x, rotateGroup(x));
+    return _mm256_or_si256(x, swapPairs(x));
+}
+
+/**
+ * @brief combines all the lanes of a row
+ */
+TARGET_AVX2 inline __m256i foldRow(__m256i x) {
+    x = foldGroup(x);
+    x = _mm256_or_si256(x, rotateGroups(x));
+    return _mm256_or_si256(x, rotateGroups2(x));
+}
+
+TARGET_AVX2 inline Count256 foldGroup(Count256 c) {
+    c = combine(c, {rotateGroup(c.seen), rotateGroup(c.twice)});
+    return combine(c, {swapPairs(c.seen), swapPairs(c.twice)});
+}
+
+TARGET_AVX2 inline Count256 foldRow(Count256 c) {
+    c = foldGroup(c);
+    c = combine(c, {rotateGroups(c.seen), rotateGroups(c.twice)});
+    return combine(c, {rotateGroups2(c.seen), rotateGroups2(c.twice)});
+}
+
+/**
+ * @brief with AVX2, a row fits in one register
+ */
+TARGET_AVX2 void scanAvx2(const std::array<std::uint8_t, 81> &cells, CandidateScan &scan) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i digits = _mm256_setr_epi16(0x1ff, 0x1ff, 0x1ff, 0, 0x1ff, 0x1ff, 0x1ff, 0, 0x1ff, 0x1ff, 0x1ff, 0,
+                                             0, 0, 0, 0);
+
+    __m256i bits[9];
+    for (int row = 0; row < 9; ++row) {
+        __m128i low, high;
+        digitBytes(loadRow(cells, row), low, high);
+        bits[row] = _mm256_or_si256(_mm256_cvtepu8_epi16(low), _mm256_slli_epi16(_mm256_cvtepu8_epi16(high), 8));
+    }
+
+    __m256i colUsed = zero;
+    __m256i boxUsed[3];
+    for (int band = 0; band < 3; ++band) {
+        __m256i used = _mm256_or_si256(_mm256_or_si256(bits[band * 3], bits[band * 3 + 1]), bits[band * 3 + 2]);
+        colUsed = _mm256_or_si256(colUsed, used);
+        boxUsed[band] = foldGroup(used);
+    }
+
+    __m256i bad = zero;
+    __m256i candidates[9];
+    __m256i rowUsed[9];
+    for (int row = 0; row < 9; ++row) {
+        rowUsed[row] = foldRow(bits[row]);
+
+        __m256i empty = _mm256_and_si256(_mm256_cmpeq_epi16(bits[row], zero), digits);
+        __m256i used = _mm256_or_si256(_mm256_or_si256(rowUsed[row], colUsed), boxUsed[row / 3]);
+        __m256i candidate = _mm256_andnot_si256(used, empty);
+        __m256i none = _mm256_cmpeq_epi16(candidate, zero);
+        bad = _mm256_or_si256(bad, _mm256_and_si256(empty, none));
+
+        __m256i single = _mm256_cmpeq_epi16(_mm256_and_si256(candidate, _mm256_sub_epi16(candidate, one)), zero);
+        candidates[row] = candidate;
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(scan.candidates[row]), candidate);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(scan.naked[row]),
+                            _mm256_and_si256(candidate, _mm256_andnot_si256(none, single)));
+    }
+
+    // a digit is a hidden single where it is a candidate once in the unit
+    Count256 col = {zero, zero};
+    __m256i boxOnce[3];
+    for (int band = 0; band < 3; ++band) {
+        Count256 box = {candidates[band * 3], zero};
+        box = combine(box, {candidates[band * 3 + 1], zero});
+        box = combine(box, {candidates[band * 3 + 2], zero});
+        col = combine(col, box);
+
+        box = foldGroup(box);
+        boxOnce[band] = _mm256_andnot_si256(box.twice, box.seen);
+        bad = _mm256_or_si256(bad, _mm256_andnot_si256(_mm256_or_si256(box.seen, boxUsed[band]), digits));
+    }
+    __m256i colOnce = _mm256_andnot_si256(col.twice, col.seen);
+    bad = _mm256_or_si256(bad, _mm256_andnot_si256(_mm256_or_si256(col.seen, colUsed), digits));
+
+    for (int row = 0; row < 9; ++row) {
+        Count256 count = foldRow(Count256{candidates[row], zero});
+        __m256i rowOnce = _mm256_andnot_si256(count.twice, count.seen);
+        bad = _mm256_or_si256(bad, _mm256_andnot_si256(_mm256_or_si256(count.seen, rowUsed[row]), digits));
+
+        __m256i once = _mm256_or_si256(_mm256_or_si256(rowOnce, colOnce), boxOnce[row / 3]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(scan.hidden[row]), _mm256_and_si256(candidates[row], once));
+    }
+
+    scan.valid = _mm256_testz_si256(bad, bad);
+}
+
+#undef TARGET_SSE41
+#undef TARGET_AVX2
+
+#endif
+
+ScanFunction function(CandidateKernel::Implementation implementation) {
+    switch (implementation) {
+#ifdef SUDOQU_X86_KERNELS
+    case CandidateKernel::AVX2:
+        return scanAvx2;
+    case CandidateKernel::SSE41:
+        return scanSse41;
+#endif
+    default:
+        return scanScalar;
+    }
+}
+}
+
+void CandidateKernel::scan(const std::array<std::uint8_t, 81> &cells, CandidateScan &scan) {
+    static const ScanFunction best = function(CandidateKernel::best());
+    best(cells, scan);
+}
+
+void CandidateKernel::scan(const std::array<std::uint8_t, 81> &cells, CandidateScan &scan,
+                           Implementation implementation) {
+    function(implementation)(cells, scan);
+}
+
+bool CandidateKernel::isSupported(Implementation implementation) {
+#ifdef SUDOQU_X86_KERNELS
+    __builtin_cpu_init();
+    switch (implementation) {
+    case SCALAR:
+        return true;
+    case SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case AVX2:
+        return __builtin_cpu_supports("avx2");
+    }
+    return false;
+#else
+    return implementation == SCALAR;
+#endif
+}
+
+CandidateKernel::Implementation CandidateKernel::best() {
+    if (isSupported(AVX2)) {
+        return AVX2;
+    }
+    if (isSupported(SSE41)) {
+        return SSE41;
+    }
+    return SCALAR;
+}
+
+const char *CandidateKernel::name(Implementation implementation) {
+    switch (implementation) {
+    case SCALAR:
+        return "scalar";
+    case SSE41:
+        return "sse4.1";
+    case AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+}
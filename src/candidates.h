@@ -0,0 +1,124 @@
+/*
+ * candidates.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_CANDIDATES_H
+#define SUDOQU_CANDIDATES_H
+
+#include <array>
+#include <cstdint>
+
+namespace Sudoqu {
+
+/**
+ * @struct CandidateScan
+ * @brief The candidates and singles of every square of a board, see Sudoqu::CandidateKernel
+ *
+ * Each row takes 16 lanes: the three columns of each box fill three lanes out of four, so
+ * a box never straddles a group of four lanes, and the last four lanes are padding. Use
+ * lane() to find a square, padding lanes are always 0.
+ */
+struct CandidateScan {
+    static const int LANES = 16;
+
+    using Rows = std::uint16_t[9][LANES];
+
+    /**
+     * @brief the digits still possible in each empty square, bit n - 1 for digit n, 0 for a given
+     */
+    alignas(32) Rows candidates;
+
+    /**
+     * @brief the candidate of the empty squares which have only one
+     */
+    alignas(32) Rows naked;
+
+    /**
+     * @brief the candidates which have no other place in the square's row, column or box
+     */
+    alignas(32) Rows hidden;
+
+    /**
+     * @brief false if an empty square has no candidate, or a unit has no place left for a digit
+     * givens repeated in a unit are not detected
+     */
+    bool valid;
+
+    /**
+     * @return the lane of a square within its row
+     */
+    static int lane(int pos) {
+        int col = pos % 9;
+        return col / 3 * 4 + col % 3;
+    }
+
+    std::uint16_t candidatesAt(int pos) const {
+        return candidates[pos / 9][lane(pos)];
+    }
+
+    std::uint16_t nakedAt(int pos) const {
+        return naked[pos / 9][lane(pos)];
+    }
+
+    std::uint16_t hiddenAt(int pos) const {
+        return hidden[pos / 9][lane(pos)];
+    }
+};
+
+/**
+ * @class CandidateKernel
+ * @brief Computes the candidates, naked singles and hidden singles of a whole board at once
+ *
+ * The SSE4.1 and AVX2 versions keep one row per register (two with SSE): columns are
+ * combined across registers, rows and boxes with a few shuffles within one. The fastest
+ * version the processor supports is picked at run time.
+ */
+class CandidateKernel {
+public:
+    enum Implementation {
+        SCALAR,
+        SSE41,
+        AVX2,
+    };
+
+    /**
+     * @brief scans a board with the fastest implementation available
+     * @param cells the 81 squares of the board, 0 for an empty square
+     * @param scan receives the result
+     */
+    static void scan(const std::array<std::uint8_t, 81> &, CandidateScan &);
+
+    /**
+     * @brief scans a board with a specific implementation, which must be supported
+     */
+    static void scan(const std::array<std::uint8_t, 81> &, CandidateScan &, Implementation);
+
+    /**
+     * @return true if the processor and the compiler support the implementation
+     */
+    static bool isSupported(Implementation);
+
+    /**
+     * @return the implementation used by scan()
+     */
+    static Implementation best();
+
+    static const char *name(Implementation);
+};
+}
+
+#endif
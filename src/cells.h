@@ -0,0 +1,91 @@
+/*
+ * cells.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SUDOQU_CELLS_H
+#define SUDOQU_CELLS_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @brief the value of each square of a board, 0 for an empty square
+ */
+using Cells = std::array<std::uint8_t, 81>;
+
+/**
+ * @brief the notes of a square, bit n - 1 is set for note n
+ */
+using Notes = std::uint16_t;
+
+/**
+ * @struct CellChanges
+ * @brief New values for some of the squares of a board
+ *
+ * A fixed size value, so a batch of moves is passed between threads and queued
+ * without allocating a container for every message.
+ */
+struct CellChanges {
+    Cells values{};
+    std::bitset<81> changed;
+
+    /**
+     * @brief records a new value, squares outside the board are ignored
+     */
+    void set(int pos, int value) {
+        if (pos >= 0 && pos < 81) {
+            values[static_cast<size_t>(pos)] = static_cast<std::uint8_t>(value);
+            changed.set(static_cast<size_t>(pos));
+        }
+    }
+
+    bool has(int pos) const {
+        return changed.test(static_cast<size_t>(pos));
+    }
+
+    int at(int pos) const {
+        return values[static_cast<size_t>(pos)];
+    }
+
+    bool empty() const {
+        return changed.none();
+    }
+
+    void clear() {
+        changed.reset();
+    }
+};
+
+inline Cells toCells(const std::vector<int> &board) {
+    Cells cells{};
+    for (size_t pos = 0; pos < cells.size() && pos < board.size(); ++pos) {
+        cells[pos] = static_cast<std::uint8_t>(board[pos]);
+    }
+    return cells;
+}
+
+inline std::vector<int> fromCells(const Cells &cells) {
+    return std::vector<int>(cells.begin(), cells.end());
+}
+}
+
+#endif
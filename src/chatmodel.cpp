@@ -0,0 +1,128 @@
+/*
+ * chatmodel.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "chatmodel.h"
+
+#include <QFont>
+
+#include <algorithm>
+
+namespace Sudoqu {
+
+ChatModel::ChatModel(int size, QObject *parent)
+    : QAbstractListModel(parent), capacity(static_cast<size_t>(std::max(1, size))) {
+    lines.reserve(capacity);
+}
+
+int ChatModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(count);
+}
+
+QVariant ChatModel::data(const QModelIndex &idx, int role) const {
+    if (!idx.isValid() || idx.row() >= static_cast<int>(count)) {
+        return QVariant();
+    }
+
+    const ChatLine &line = at(idx.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        if (line.name.isEmpty()) {
+            return line.text;
+        }
+        return QString("%1: %2").arg(line.name).arg(line.text);
+
+    case Qt::FontRole:
+        if (line.name.isEmpty()) {
+            QFont font;
+            font.setItalic(true);
+            return font;
+        }
+        return QVariant();
+    }
+
+    return QVariant();
+}
+
+void ChatModel::append(const QString &name, const QString &text) {
+    if (count == capacity) {
+        drop(1);
+    }
+
+    beginInsertRows(QModelIndex(), static_cast<int>(count), static_cast<int>(count));
+    store(ChatLine(name, text));
+    endInsertRows();
+}
+
+void ChatModel::append(const std::vector<ChatLine> &added) {
+    if (added.empty()) {
+        return;
+    }
+
+    // only the last lines of a long batch would survive
+    auto from = added.begin();
+    if (added.size() > capacity) {
+        from = added.end() - static_cast<std::ptrdiff_t>(capacity);
+    }
+    size_t size = static_cast<size_t>(added.end() - from);
+
+    if (count + size > capacity) {
+        drop(count + size - capacity);
+    }
+
+    beginInsertRows(QModelIndex(), static_cast<int>(count), static_cast<int>(count + size - 1));
+    for (auto it = from; it != added.end(); ++it) {
+        store(*it);
+    }
+    endInsertRows();
+}
+
+void ChatModel::notice(const QString &text) {
+    append(QString(), text);
+}
+
+void ChatModel::clear() {
+    beginResetModel();
+    lines.clear();
+    first = 0;
+    count = 0;
+    endResetModel();
+}
+
+void ChatModel::drop(size_t size) {
+    beginRemoveRows(QModelIndex(), 0, static_cast<int>(size - 1));
+    first = (first + size) % capacity;
+    count -= size;
+    endRemoveRows();
+}
+
+void ChatModel::store(const ChatLine &line) {
+    size_t slot = (first + count) % capacity;
+    if (slot < lines.size()) {
+        lines[slot] = line;
+    } else {
+        lines.push_back(line);
+    }
+    ++count;
+}
+
+const ChatLine &ChatModel::at(int row) const {
+    return lines[(first + static_cast<size_t>(row)) % capacity];
+}
+}
@@ -0,0 +1,99 @@
+/*
+ * chatmodel.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_CHATMODEL_H
+#define SUDOQU_CHATMODEL_H
+
+#include "network.h"
+
+#include <QAbstractListModel>
+
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class ChatModel
+ * @brief The chat log, keeping only the most recent lines
+ *
+ * Lines are stored in a ring buffer of fixed capacity: once it is full, each new
+ * line replaces the oldest one, so the log uses the same memory however long it runs.
+ */
+class ChatModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    /**
+     * @param capacity the number of lines kept
+     * @param parent the parent object
+     */
+    explicit ChatModel(int = 1000, QObject * = nullptr);
+
+    int rowCount(const QModelIndex & = QModelIndex()) const override;
+    QVariant data(const QModelIndex &, int = Qt::DisplayRole) const override;
+
+    /**
+     * @brief adds a message sent by a player
+     * @param name the player's name
+     * @param text the message
+     */
+    void append(const QString &, const QString &);
+
+    /**
+     * @brief adds several messages at once, e.g. the history sent by the server
+     * @param lines the messages, oldest first
+     */
+    void append(const std::vector<ChatLine> &);
+
+    /**
+     * @brief adds an event that was not sent by a player (connections, teams...)
+     * @param text the event
+     */
+    void notice(const QString &);
+
+    /**
+     * @brief removes all the lines
+     */
+    void clear();
+
+private:
+    std::vector<ChatLine> lines;
+    size_t capacity;
+
+    /**
+     * @brief position in lines of the oldest line
+     */
+    size_t first = 0;
+
+    size_t count = 0;
+
+    /**
+     * @brief removes the oldest lines
+     */
+    void drop(size_t);
+
+    /**
+     * @brief writes a line after the last one, between beginInsertRows and endInsertRows
+     */
+    void store(const ChatLine &);
+
+    const ChatLine &at(int) const;
+};
+}
+
+#endif
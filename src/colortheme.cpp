@@ -114,4 +114,23 @@ ColorTheme::ColorTheme(Theme theme) {
     other_focus_background = themes[theme]["other_focus_background"];
     other_focus_foreground = themes[theme]["other_focus_foreground"];
 }
+
+ColorPalette::ColorPalette() : ColorPalette(ColorTheme()) {
+}
+
+ColorPalette::ColorPalette(const ColorTheme &theme) {
+    background[EMPTY] = QBrush(QColor(theme.background));
+    foreground[EMPTY] = QPen(QColor(theme.foreground));
+    background[GIVEN] = QBrush(QColor(theme.given_background));
+    foreground[GIVEN] = QPen(QColor(theme.given_foreground));
+    background[FOCUS] = QBrush(QColor(theme.focus_background));
+    foreground[FOCUS] = QPen(QColor(theme.focus_foreground));
+    background[FILLED] = QBrush(QColor(theme.filled_background));
+    foreground[FILLED] = QPen(QColor(theme.filled_foreground));
+    background[OTHER_FOCUS] = QBrush(QColor(theme.other_focus_background));
+    foreground[OTHER_FOCUS] = QPen(QColor(theme.other_focus_foreground));
+
+    outer_lines = QPen(QColor(theme.outer_lines), 5);
+    inner_lines = QPen(QColor(theme.inner_lines), 1);
+}
 }
@@ -19,9 +19,13 @@
 #ifndef SUDOQU_COLORTHEME_H
 #define SUDOQU_COLORTHEME_H
 
+#include <QBrush>
+#include <QColor>
 #include <QMetaType>
+#include <QPen>
 #include <QString>
 
+#include <array>
 #include <map>
 #include <vector>
 
@@ -61,6 +65,34 @@ struct ColorTheme {
     ColorTheme(Theme);
 };
 
+/**
+ * @struct ColorPalette
+ * @brief A ColorTheme with its colours parsed, ready to be used for painting
+ */
+struct ColorPalette {
+
+    /**
+     * @brief the state of a square, which decides its colours
+     */
+    enum Role : int {
+        EMPTY,
+        GIVEN,
+        FOCUS,
+        FILLED,
+        OTHER_FOCUS,
+        ROLES,
+    };
+
+    std::array<QBrush, ROLES> background;
+    std::array<QPen, ROLES> foreground;
+
+    QPen outer_lines;
+    QPen inner_lines;
+
+    ColorPalette();
+    explicit ColorPalette(const ColorTheme &);
+};
+
 QDataStream &operator<<(QDataStream &, const ColorTheme &);
 
 QDataStream &operator>>(QDataStream &, ColorTheme &);
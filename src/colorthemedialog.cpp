@@ -35,7 +35,7 @@ ColorThemeDialog::ColorThemeDialog(ColorTheme current_theme, GameFrame *frame, Q
         int selected = ui->select_theme->currentData().toInt();
         theme = ColorTheme(static_cast<ColorTheme::Theme>(selected));
         frame->setColorTheme(theme);
-        frame->repaint();
+        frame->update();
         reloadColors();
     });
 
@@ -81,7 +81,7 @@ void ColorThemeDialog::reloadColors() {
                     *w.second = color.name();
                     widget->setStyleSheet("background-color: " + *w.second);
                     frame->setColorTheme(theme);
-                    frame->repaint();
+                    frame->update();
                 }
             });
             widgets.push_back(std::unique_ptr<QWidget>(label));
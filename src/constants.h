@@ -19,7 +19,7 @@
 #ifndef SUDOQU_CONSTANTS_H
 #define SUDOQU_CONSTANTS_H
 
-#define SUDOQU_VERSION 9
+#define SUDOQU_VERSION 15
 
 namespace Sudoqu {
 
@@ -40,6 +40,15 @@ enum Messages : int {
     SET_FOCUS,
     UPDATE_NOTES,
     YOUR_ID,
+    PING,
+    PONG,
+    SESSION_RESUMED,
+    CHAT_HISTORY,
+
+    /**
+     * @brief number of message types, must stay last
+     */
+    MESSAGE_TYPES,
 };
 
 enum GameMode : int {
@@ -49,6 +58,31 @@ enum GameMode : int {
 };
 
 static const int MAX_PLAYERNAME_LENGTH = 25;
+
+/**
+ * @brief milliseconds between two PING sent by the server
+ */
+static const int PING_INTERVAL = 5000;
+
+/**
+ * @brief milliseconds without receiving anything before a peer is considered dead
+ */
+static const int IDLE_TIMEOUT = 20000;
+
+/**
+ * @brief milliseconds during which the server keeps the state of a dropped player so they can resume
+ */
+static const int RESUME_GRACE_PERIOD = 60000;
+
+/**
+ * @brief milliseconds during which a client collects its moves and focus changes before sending them
+ */
+static const int INPUT_BATCH_DELAY = 30;
+
+/**
+ * @brief number of chat lines the server keeps and sends to players who join
+ */
+static const int CHAT_HISTORY_SIZE = 50;
 }
 
 #endif
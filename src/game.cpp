@@ -17,32 +17,90 @@
  */
 
 #include "game.h"
+#include "isomorph.h"
+#include "solver.h"
 
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QTcpSocket>
+#include <QUuid>
 
 #include <algorithm>
 
 namespace Sudoqu {
 
+namespace {
+bool hasUniqueSolution(const std::vector<int> &puzzle, const std::vector<int> &solution) {
+    Solver solver(puzzle);
+    return solver.countSolutions() == 1 && solver.getSolution() == solution;
+}
+}
+
 Game::Game(QObject *parent) : QTcpServer(parent) {
     current_id = 0;
     mode = NOT_PLAYING;
+
+    clock.start();
+    heartbeat.setInterval(PING_INTERVAL);
+    connect(&heartbeat, &QTimer::timeout, this, &Game::sendHeartbeat);
 }
 
 void Game::start_game(SB::Difficulty difficulty, GameMode mode) {
+    std::unique_ptr<Sudoku> sudoku(new Sudoku(random.next()));
+    PuzzleBank::Entry entry;
+    if (bank.sample(difficulty, random, entry) && hasUniqueSolution(entry.puzzle, entry.solution)) {
+        sudoku->setBoard(entry.puzzle, entry.solution);
+        // so a small bank does not give the same boards over and over
+        sudoku->shuffle(random.next());
+    } else {
+        if (!entry.solution.empty()) {
+            qWarning() << "Skipping a bank puzzle without a unique solution matching the one stored";
+        }
+        sudoku->generate(difficulty);
+    }
+    start_game(std::move(sudoku), mode);
+}
+
+bool Game::start_game(const std::vector<int> &puzzle, const std::vector<int> &solution, GameMode mode) {
+    if (!hasUniqueSolution(puzzle, solution)) {
+        qWarning() << "Refusing a puzzle without a unique solution matching the one given";
+        return false;
+    }
+
+    std::unique_ptr<Sudoku> sudoku(new Sudoku);
+    sudoku->setBoard(puzzle, solution);
+    start_game(std::move(sudoku), mode);
+    return true;
+}
+
+void Game::start_game(std::unique_ptr<Sudoku> sudoku, GameMode mode) {
     this->mode = mode;
+    ++game_number;
 
     coop_boards.clear();
+    coop_revisions.clear();
     notes.clear();
     player_boards.clear();
 
-    board.reset(new Sudoku);
-    board->generate(difficulty);
+    board = std::move(sudoku);
 
     auto puzzle = board->getPuzzle();
 
+    if (!recording_directory.isEmpty()) {
+        QString date = QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+        QString name = QString("%1-%2.sqr").arg(date).arg(game_number);
+        recorder.start(recording_directory + "/" + name, mode, teams, puzzle, board->getSolution());
+        for (auto &p : players) {
+            if (!p.second->getName().isEmpty()) {
+                recorder.join(p.second->getId(), p.second->getName(), p.second->getTeam());
+            }
+        }
+    }
+
     if (mode == COOP) {
         for (auto team : teams) {
             coop_boards[team] = puzzle;
@@ -61,13 +119,156 @@ void Game::start_game(SB::Difficulty difficulty, GameMode mode) {
     }
 
     active = true;
+    finished = false;
     sendStatusChanges();
+
+    if (journal) {
+        journal->snapshot(saveState());
+    }
 }
 
 void Game::setTeamNames(QStringList teams) {
     this->teams = teams;
 }
 
+void Game::setRecordingDirectory(const QString &directory) {
+    recording_directory = directory;
+    if (!directory.isEmpty()) {
+        QDir().mkpath(directory);
+    }
+}
+
+bool Game::setPuzzleBank(const QString &path) {
+    if (path.isEmpty()) {
+        bank.close();
+        return true;
+    }
+    return bank.open(path);
+}
+
+const Metrics &Game::getMetrics() const {
+    return metrics;
+}
+
+bool Game::start_metrics(quint16 port) {
+    metrics_server.reset(new MetricsServer(metrics, this));
+    if (!metrics_server->start(port)) {
+        metrics_server.reset();
+        return false;
+    }
+    return true;
+}
+
+bool Game::start_journal(const QString &directory) {
+    journal.reset(new Journal(directory));
+
+    GameState state;
+    bool restored = journal->restore(state);
+    if (restored) {
+        restoreState(state);
+    }
+
+    journal->snapshot(saveState());
+    return restored;
+}
+
+GameState Game::saveState() const {
+    GameState state;
+    state.mode = mode;
+    state.active = active && !finished && board;
+    state.current_id = current_id;
+
+    if (board) {
+        state.puzzle = board->getPuzzle();
+        state.solution = board->getSolution();
+    }
+
+    if (mode == COOP) {
+        state.boards = coop_boards;
+    }
+    state.notes = notes;
+
+    for (auto &p : players) {
+        Player *player = p.second.get();
+        if (player->getName().isEmpty()) {
+            continue;
+        }
+        GameState::PlayerState &saved = state.players[player->getToken()];
+        saved.id = player->getId();
+        saved.name = player->getName();
+        saved.team = player->getTeam();
+
+        auto player_board = player_boards.find(player);
+        if (mode != COOP && player_board != player_boards.end()) {
+            state.boards[player->getToken()] = player_board->second;
+        }
+    }
+
+    for (auto &s : sessions) {
+        const Session &session = s.second;
+        GameState::PlayerState &saved = state.players[s.first];
+        saved.id = session.id;
+        saved.name = session.name;
+        saved.team = session.team;
+
+        if (mode != COOP && session.game == game_number && !session.board.empty()) {
+            state.boards[s.first] = session.board;
+        }
+    }
+
+    return state;
+}
+
+void Game::restoreState(GameState &state) {
+    mode = state.mode;
+    active = state.active && !state.puzzle.empty();
+    finished = false;
+    current_id = std::max(current_id, state.current_id);
+    ++game_number;
+
+    if (!state.puzzle.empty()) {
+        board.reset(new Sudoku);
+        board->setBoard(state.puzzle, state.solution);
+    }
+
+    coop_boards.clear();
+    coop_revisions.clear();
+    if (mode == COOP) {
+        coop_boards = state.boards;
+        for (auto &team : teams) {
+            if (coop_boards.find(team) == coop_boards.end()) {
+                coop_boards[team] = state.puzzle;
+            }
+        }
+    }
+    notes = state.notes;
+
+    qint64 expires = clock.elapsed() + RESUME_GRACE_PERIOD;
+    for (auto &p : state.players) {
+        Session &session = sessions[p.first];
+        session.id = p.second.id;
+        session.name = p.second.name;
+        session.team = p.second.team;
+        session.game = game_number;
+        session.expires = expires;
+        session.resync = true;
+        if (mode != COOP) {
+            auto saved = state.boards.find(p.first);
+            session.board = saved != state.boards.end() ? saved->second : state.puzzle;
+        }
+    }
+}
+
+void Game::recordPlayer(Player *player) {
+    if (player->getName().isEmpty()) {
+        return;
+    }
+    if (journal) {
+        journal->player(player->getToken(), player->getId(), player->getName(), player->getTeam());
+    }
+    recorder.join(player->getId(), player->getName(), player->getTeam());
+}
+
 void Game::start_server(bool acceptRemote) {
     QHostAddress host = QHostAddress::AnyIPv4;
 
@@ -77,6 +278,7 @@ void Game::start_server(bool acceptRemote) {
 
     listen(host, 19770);
     connect(this, &QTcpServer::newConnection, this, &Game::clientConnected);
+    heartbeat.start();
 }
 
 void Game::stop_server() {
@@ -87,22 +289,30 @@ void Game::stop_server() {
 }
 
 void Game::clientConnected() {
-    QTcpSocket *socket = nextPendingConnection();
+    addPlayer(nextPendingConnection());
+}
+
+Player *Game::addPlayer(QTcpSocket *socket) {
     socket->setParent(this);
 
     connect(socket, &QTcpSocket::readyRead, this, &Game::dataReceived);
+    connect(socket, &QTcpSocket::disconnected, this, [=]() { clientDropped(socket); });
 
     ++current_id;
+    metrics.connectionOpened();
 
     players[socket] = std::make_unique<Player>(socket);
 
     Player *player = players[socket].get();
 
     player->setId(current_id);
+    connections[player].last_seen = clock.elapsed();
+    player->setToken(QUuid::createUuid().toString());
 
     QJsonObject obj;
     obj["message"] = YOUR_ID;
     obj["id"] = current_id;
+    obj["token"] = player->getToken();
 
     QJsonArray team_array = QJsonArray::fromStringList(teams);
     obj["teams"] = team_array;
@@ -122,12 +332,14 @@ void Game::clientConnected() {
     for (auto &p : list) {
         newPlayer["id"] = p->getId();
         newPlayer["name"] = p->getName();
-        Network::sendNetworkMessage(newPlayer, *player);
+        sendMessageToPlayer(newPlayer, player);
     }
 
     if (active) {
         player_boards[player] = board->getPuzzle();
     }
+
+    return player;
 }
 
 void Game::clientDisconnected(QTcpSocket *socket) {
@@ -143,13 +355,140 @@ void Game::clientDisconnected(QTcpSocket *socket) {
 
     sendMessageToAllPlayers(send, player);
 
+    connections.erase(player);
     players.erase(socket);
+    metrics.connectionClosed();
 
     sendStatusChanges(player);
 }
 
+void Game::clientDropped(QTcpSocket *socket) {
+    auto it = players.find(socket);
+    if (it == players.end()) {
+        return;
+    }
+
+    Player *player = it->second.get();
+
+    // players who never sent their name have nothing worth resuming
+    if (!player->getName().isEmpty()) {
+        Session &session = sessions[player->getToken()];
+        session.id = player->getId();
+        session.name = player->getName();
+        session.team = player->getTeam();
+        session.game = game_number;
+        session.board = mode == COOP ? coop_boards[player->getTeam()] : player_boards[player];
+        session.notes = notes[player->getTeam()];
+        session.expires = clock.elapsed() + RESUME_GRACE_PERIOD;
+        session.last_seq = connections[player].last_seq;
+    }
+
+    QJsonObject unfocus;
+    unfocus["message"] = SET_FOCUS;
+    unfocus["id"] = player->getId();
+    unfocus["pos"] = -1;
+    sendMessageToAllPlayers(unfocus, player);
+
+    player_boards.erase(player);
+    connections.erase(player);
+    players.erase(it);
+    metrics.connectionClosed();
+
+    sendStatusChanges();
+}
+
+bool Game::resumeSession(Player *player, QString token) {
+    auto it = sessions.find(token);
+    if (it == sessions.end()) {
+        return false;
+    }
+
+    Session session = std::move(it->second);
+    sessions.erase(it);
+
+    player->setId(session.id);
+    player->setToken(token);
+    connections[player].last_seq = session.last_seq;
+    player->setName(generatePlayerName(session.id, session.name));
+    assign_team(player, session.team, false);
+    if (player->getName() != session.name) {
+        recordPlayer(player);
+    }
+
+    QJsonObject obj;
+    obj["message"] = SESSION_RESUMED;
+    obj["id"] = session.id;
+    obj["name"] = player->getName();
+    obj["team"] = session.team;
+    obj["token"] = token;
+    obj["last_seq"] = static_cast<qint64>(session.last_seq);
+    sendMessageToPlayer(obj, player);
+
+    if (!active) {
+        return true;
+    }
+
+    if (session.game != game_number) {
+        if (mode != COOP) {
+            player_boards[player] = board->getPuzzle();
+        }
+        QJsonObject obj(sendBoard(mode == COOP ? session.team : ""));
+        sendMessageToPlayer(obj, player);
+        return true;
+    }
+
+    if (player->getName() == session.name) {
+        recorder.join(player->getId(), player->getName(), player->getTeam());
+    }
+
+    if (session.resync) {
+        if (mode != COOP) {
+            player_boards[player] = std::move(session.board);
+        }
+        QJsonObject obj(sendBoard(mode == COOP ? session.team : "", player));
+        sendMessageToPlayer(obj, player);
+        return true;
+    }
+
+    if (mode != COOP) {
+        player_boards[player] = std::move(session.board);
+        return true;
+    }
+
+    // coop: only send what the team changed while the player was away
+    std::vector<int> &current = coop_boards[session.team];
+    QJsonObject cells;
+    for (size_t i = 0; i < current.size(); ++i) {
+        if (i >= session.board.size() || session.board[i] != current[i]) {
+            cells[QString::number(i)] = current[i];
+        }
+    }
+    if (!cells.isEmpty()) {
+        QJsonObject values;
+        values["message"] = NEW_VALUE;
+        values["cells"] = cells;
+        values["rev"] = static_cast<qint64>(coop_revisions[session.team]);
+        sendMessageToPlayer(values, player);
+    }
+
+    for (auto &note_list : notes[session.team]) {
+        auto seen = session.notes.find(note_list.first);
+        if (seen == session.notes.end() || seen->second != note_list.second) {
+            QJsonObject update;
+            update["message"] = UPDATE_NOTES;
+            update["pos"] = note_list.first;
+            std::list<QVariant> list_notes(note_list.second.begin(), note_list.second.end());
+            update["notes"] = QJsonArray::fromVariantList(QVariantList::fromStdList(list_notes));
+            sendMessageToPlayer(update, player);
+        }
+    }
+
+    return true;
+}
+
 void Game::sendMessageToPlayer(QJsonObject &obj, Player *player) {
-    Network::sendNetworkMessage(obj, *player);
+    qint64 bytes = Network::sendNetworkMessage(obj, *player);
+    metrics.messageSent(obj["message"].toInt(), bytes);
 }
 
 void Game::sendMessageToAllPlayers(QJsonObject &obj, Player *except) {
@@ -158,6 +497,7 @@ void Game::sendMessageToAllPlayers(QJsonObject &obj, Player *except) {
 }
 
 void Game::sendMessageToPlayers(QJsonObject &obj, std::vector<Player *> &players) {
+    metrics.broadcast(players.size());
     for (Player *p : players) {
         sendMessageToPlayer(obj, p);
     }
@@ -178,7 +518,7 @@ bool Game::checkSolution(std::vector<int> &board) const {
     return board == solution;
 }
 
-QJsonObject Game::sendBoard(QString team) {
+QJsonObject Game::sendBoard(QString team, Player *player) {
     QJsonObject obj;
     obj["message"] = NEW_GAME;
     obj["mode"] = mode;
@@ -188,10 +528,14 @@ QJsonObject Game::sendBoard(QString team) {
     QJsonArray array = QJsonArray::fromVariantList(QList<QVariant>::fromStdList(list));
     obj["given"] = array;
 
+    // 64 bit integers do not survive JSON numbers
+    obj["solution_hash"] = QString::number(Isomorph::hash(board->getSolution()), 16);
+
     if (mode == COOP) {
         std::list<QVariant> list_coop(coop_boards[team].begin(), coop_boards[team].end());
         QJsonArray coop_json = QJsonArray::fromVariantList(QList<QVariant>::fromStdList(list_coop));
         obj["board"] = coop_json;
+        obj["rev"] = static_cast<qint64>(coop_revisions[team]);
 
         QJsonObject obj_notes;
         for (auto &note_list : notes[team]) {
@@ -200,6 +544,12 @@ QJsonObject Game::sendBoard(QString team) {
                 QJsonArray::fromVariantList(QVariantList::fromStdList(list_notes));
         }
         obj["notes"] = obj_notes;
+    } else if (player != nullptr) {
+        auto player_board = player_boards.find(player);
+        if (player_board != player_boards.end()) {
+            std::list<QVariant> list_board(player_board->second.begin(), player_board->second.end());
+            obj["board"] = QJsonArray::fromVariantList(QVariantList::fromStdList(list_board));
+        }
     }
     return obj;
 }
@@ -207,6 +557,8 @@ QJsonObject Game::sendBoard(QString team) {
 void Game::assign_team(Player *player, QString team, bool send) {
     player->setTeam(team);
     if (send) {
+        recordPlayer(player);
+
         QJsonObject obj;
         obj["message"] = CHANGE_TEAM;
         obj["player"] = player->getName();
@@ -228,6 +580,8 @@ int Game::getCount(std::vector<int> &board) {
 }
 
 void Game::gameOverWinner(QString team) {
+    finished = true;
+
     QJsonObject obj;
     obj["message"] = GAME_OVER_WINNER;
     obj["team"] = team;
@@ -235,6 +589,8 @@ void Game::gameOverWinner(QString team) {
 }
 
 void Game::gameOverWinner(Player *player) {
+    finished = true;
+
     QJsonObject obj;
     obj["message"] = GAME_OVER_WINNER;
     obj["player"] = player->getName();
@@ -286,7 +642,7 @@ void Game::sendStatusChanges(Player *except) {
             if (player != except) {
                 bool done = active && checkSolution(player_boards[player]);
                 int count = !active ? 0 : getCount(player_boards[player]);
-                changes.push_back(StatusChange(done, count, player->getName()).toJson());
+                changes.push_back(StatusChange(done, count, player->getName(), connections[player].latency).toJson());
             }
         }
     } else {
@@ -294,13 +650,15 @@ void Game::sendStatusChanges(Player *except) {
             auto players_in_team = listPlayersInTeam(team);
             if (!players_in_team.empty()) {
                 QStringList player_names;
+                int latency = -1;
                 for (auto player : players_in_team) {
                     player_names.push_back(player->getName());
+                    latency = std::max(latency, connections[player].latency);
                 }
                 QString fullName = QString("%1: %2").arg(team).arg(player_names.join(", "));
                 bool done = active && checkSolution(coop_boards[team]);
                 int count = !active ? 0 : getCount(coop_boards[team]);
-                changes.push_back(StatusChange(done, count, fullName).toJson());
+                changes.push_back(StatusChange(done, count, fullName, latency).toJson());
             }
         }
     }
@@ -312,153 +670,347 @@ void Game::sendStatusChanges(Player *except) {
     sendMessageToAllPlayers(obj);
 }
 
+void Game::sendHeartbeat() {
+    qint64 now = clock.elapsed();
+
+    std::vector<QTcpSocket *> idle;
+    for (auto &p : players) {
+        if (now - connections[p.second.get()].last_seen > IDLE_TIMEOUT) {
+            idle.push_back(p.first);
+        }
+    }
+
+    for (QTcpSocket *socket : idle) {
+        clientDropped(socket);
+        socket->abort();
+    }
+
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (it->second.expires < now) {
+            QJsonObject send;
+            send["message"] = DISCONNECT;
+            send["name"] = it->second.name;
+            sendMessageToAllPlayers(send);
+            if (journal) {
+                journal->playerLeft(it->first);
+            }
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (players.empty()) {
+        return;
+    }
+
+    QJsonObject ping;
+    ping["message"] = PING;
+    ping["ts"] = static_cast<double>(now);
+    sendMessageToAllPlayers(ping);
+    for (auto &p : players) {
+        connections[p.second.get()].ping_sent = now;
+    }
+
+    sendStatusChanges();
+}
+
 void Game::dataReceived() {
     QTcpSocket *socket = static_cast<QTcpSocket *>(this->sender());
-    Player *player = players[socket].get();
-    QString data;
+    QByteArray data;
     while (socket && socket->canReadLine()) {
+        auto it = players.find(socket);
+        if (it == players.end()) {
+            break;
+        }
+
         data = socket->readLine();
+        connections[it->second.get()].last_seen = clock.elapsed();
+
+        QElapsedTimer timer;
+        timer.start();
+
         QJsonObject obj = Network::readNetworkMessage(data);
-        if (obj.contains("message")) {
-            int id = obj["id"].toInt();
-            int message = obj["message"].toInt();
-
-            switch (message) {
-            case SEND_NAME: {
-                if (obj.find("version") == obj.end() || obj["version"].toInt() != SUDOQU_VERSION) {
-                    QJsonObject bad;
-                    bad["message"] = BAD_VERSION;
-                    bad["server_version"] = SUDOQU_VERSION;
-                    bad["client_version"] = obj["version"].toInt();
-                    sendMessageToPlayer(bad, player);
-                    return;
-                }
-                if (id == player->getId()) {
-                    QString name = generatePlayerName(id, obj["name"].toString());
-                    player->setName(name);
-                    obj["name"] = name;
-                    obj["message"] = NEW_PLAYER;
-                    sendMessageToAllPlayers(obj);
-                }
+        int message = obj.contains("message") ? obj["message"].toInt() : -1;
+        if (message >= 0) {
+            processMessage(it->second.get(), obj);
+        }
 
-                if (active) {
-                    QJsonObject obj(sendBoard(mode == COOP ? player->getTeam() : ""));
-                    sendMessageToPlayer(obj, player);
-                }
+        metrics.messageReceived(message, data.size(), static_cast<quint64>(timer.nsecsElapsed() / 1000));
+    }
+}
 
-                sendStatusChanges();
-                break;
+void Game::processMessage(Player *player, QJsonObject &obj) {
+    QTcpSocket *socket = *player;
+    int id = obj["id"].toInt();
+    int message = obj["message"].toInt();
+
+    switch (message) {
+    case SEND_NAME: {
+        if (obj.find("version") == obj.end() || obj["version"].toInt() != SUDOQU_VERSION) {
+            QJsonObject bad;
+            bad["message"] = BAD_VERSION;
+            bad["server_version"] = SUDOQU_VERSION;
+            bad["client_version"] = obj["version"].toInt();
+            sendMessageToPlayer(bad, player);
+            return;
+        }
+        if (obj.contains("resume") && resumeSession(player, obj["resume"].toString())) {
+            sendStatusChanges();
+            break;
+        }
+        if (id == player->getId()) {
+            QString name = generatePlayerName(id, obj["name"].toString());
+            player->setName(name);
+            recordPlayer(player);
+            obj["name"] = name;
+            obj["message"] = NEW_PLAYER;
+            sendMessageToAllPlayers(obj);
+
+            if (!chat_history.empty()) {
+                QJsonArray lines;
+                for (auto &line : chat_history) {
+                    lines.append(line.toJson());
+                }
+                QJsonObject history;
+                history["message"] = CHAT_HISTORY;
+                history["lines"] = lines;
+                sendMessageToPlayer(history, player);
             }
-            case CHAT_MESSAGE:
-                obj["name"] = player->getName();
-                sendMessageToAllPlayers(obj, player);
-                break;
+        }
 
-            case DISCONNECT:
-                clientDisconnected(socket);
-                break;
+        if (active) {
+            QJsonObject obj(sendBoard(mode == COOP ? player->getTeam() : ""));
+            sendMessageToPlayer(obj, player);
+        }
 
-            case NEW_VALUE: {
-                if (mode == COOP) {
-                    QString team = player->getTeam();
-                    auto list_players = listPlayersInTeam(team, player);
-                    sendMessageToPlayers(obj, list_players);
-                }
+        sendStatusChanges();
+        break;
+    }
+    case CHAT_MESSAGE:
+        obj["name"] = player->getName();
+        sendMessageToAllPlayers(obj, player);
 
-                std::map<size_t, int> values;
-
-                if (obj.find("values") == obj.end()) {
-                    size_t pos = static_cast<size_t>(obj["pos"].toInt());
-                    int val = obj["val"].toInt();
-                    values[pos] = val;
-                } else {
-                    auto tmp_values = obj["values"].toArray();
-                    for (int i = 0; i < tmp_values.size(); ++i) {
-                        values[static_cast<size_t>(i)] = tmp_values[i].toInt();
-                    }
-                }
+        chat_history.emplace_back(player->getName(), obj["text"].toString());
+        if (chat_history.size() > static_cast<size_t>(CHAT_HISTORY_SIZE)) {
+            chat_history.pop_front();
+        }
+        break;
 
-                for (auto update : values) {
-                    size_t pos = update.first;
-                    int val = update.second;
-
-                    if (mode == COOP) {
-                        QString team = player->getTeam();
-                        coop_boards[team][pos] = val;
-                        if (checkSolution(coop_boards[team])) {
-                            gameOverWinner(team);
-                        }
-                    } else {
-                        player_boards[player][pos] = val;
-                        if (checkSolution(player_boards[player])) {
-                            gameOverWinner(player);
-                        }
-                    }
-                }
+    case DISCONNECT:
+        if (journal) {
+            journal->playerLeft(player->getToken());
+        }
+        clientDisconnected(socket);
+        break;
 
-                sendStatusChanges();
+    case NEW_VALUE: {
+        if (!active) {
+            break;
+        }
+
+        // moves sent again after resuming a session, which were applied before the connection dropped
+        if (obj.contains("seq")) {
+            quint64 seq = static_cast<quint64>(obj["seq"].toDouble());
+            quint64 &last_seq = connections[player].last_seq;
+            if (seq <= last_seq) {
                 break;
             }
+            last_seq = seq;
+        }
 
-            case CHANGE_NAME:
-                obj["id"] = player->getId();
-                obj["old_name"] = player->getName();
-                obj["new_name"] = generatePlayerName(player->getId(), obj["new_name"].toString());
-                player->setName(obj["new_name"].toString());
-                sendMessageToAllPlayers(obj);
-                sendStatusChanges();
-                break;
+        std::map<size_t, int> values;
 
-            case SET_FOCUS: {
-                QString team = player->getTeam();
-                std::vector<Player *> list_players;
-                for (auto p : players) {
-                    if (p.second->getTeam() == team && p.second.get() != player) {
-                        list_players.push_back(p.second.get());
-                    }
-                }
-                if (!list_players.empty()) {
-                    sendMessageToPlayers(obj, list_players);
+        // everything below writes to the boards, the journal and the recording
+        auto add = [&values](int pos, int val) {
+            if (pos >= 0 && pos < 81 && val >= 0 && val <= 9) {
+                values[static_cast<size_t>(pos)] = val;
+            }
+        };
+
+        if (obj.contains("cells")) {
+            QJsonObject cells = obj["cells"].toObject();
+            for (auto it = cells.begin(); it != cells.end(); ++it) {
+                bool ok = false;
+                int pos = it.key().toInt(&ok);
+                if (ok) {
+                    add(pos, it.value().toInt(-1));
                 }
-                break;
             }
+        } else if (obj.find("values") == obj.end()) {
+            add(obj["pos"].toInt(-1), obj["val"].toInt(-1));
+        } else {
+            auto tmp_values = obj["values"].toArray();
+            for (int i = 0; i < tmp_values.size(); ++i) {
+                add(i, tmp_values[i].toInt(-1));
+            }
+        }
 
-            case CHANGE_TEAM: {
-                QString team = obj["team"].toString();
-                if (player->getTeam() != team) {
-                    assign_team(player, team, true);
-                    if (active) {
-                        obj = sendBoard(mode == COOP ? team : "");
-                        sendMessageToPlayer(obj, player);
-
-                        QJsonObject unfocus;
-                        unfocus["message"] = SET_FOCUS;
-                        unfocus["id"] = player->getId();
-                        unfocus["pos"] = -1;
-                        sendMessageToAllPlayers(unfocus, player);
-                    }
-
-                    sendStatusChanges();
-                }
-                break;
+        std::vector<int> &target = mode == COOP ? coop_boards[player->getTeam()] : player_boards[player];
+        for (auto it = values.begin(); it != values.end();) {
+            if (it->first >= target.size()) {
+                it = values.erase(it);
+            } else {
+                ++it;
             }
+        }
+
+        for (auto update : values) {
+            size_t pos = update.first;
+            int val = update.second;
 
-            case UPDATE_NOTES: {
-                int position = obj["pos"].toInt();
-                std::vector<int> &team_notes = notes[player->getTeam()][position];
-                team_notes.clear();
-                auto list = obj["notes"].toArray();
-                for (auto i : list) {
-                    team_notes.push_back(i.toInt());
+            target[pos] = val;
+            if (mode == COOP) {
+                QString team = player->getTeam();
+                recorder.value(player->getId(), static_cast<int>(pos), val);
+                if (journal) {
+                    journal->value(team, static_cast<int>(pos), val);
                 }
-                if (mode == COOP) {
-                    auto players = listPlayersInTeam(player->getTeam(), player);
-                    sendMessageToPlayers(obj, players);
+            } else {
+                recorder.value(player->getId(), static_cast<int>(pos), val);
+                if (journal) {
+                    journal->value(player->getToken(), static_cast<int>(pos), val);
                 }
-                break;
             }
+        }
+
+        // coop: the whole team, sender included, gets the moves in the order the server applied them
+        if (mode == COOP) {
+            QString team = player->getTeam();
+            QJsonObject cells;
+            for (auto update : values) {
+                cells[QString::number(update.first)] = update.second;
+            }
+
+            QJsonObject echo;
+            echo["message"] = NEW_VALUE;
+            echo["cells"] = cells;
+            echo["rev"] = static_cast<qint64>(++coop_revisions[team]);
+            echo["id"] = player->getId();
+            if (obj.contains("seq")) {
+                echo["seq"] = obj["seq"];
+            }
+            auto list_players = listPlayersInTeam(team);
+            sendMessageToPlayers(echo, list_players);
+        }
+
+        // checked once per message, a batch of moves can only win once
+        bool was_finished = finished;
+        if (mode == COOP) {
+            if (checkSolution(coop_boards[player->getTeam()])) {
+                gameOverWinner(player->getTeam());
+            }
+        } else if (checkSolution(player_boards[player])) {
+            gameOverWinner(player);
+        }
+
+        // saved right away when the game is won, so a restart does not bring it back
+        if (journal && (finished != was_finished || journal->snapshotDue())) {
+            journal->snapshot(saveState());
+        }
+
+        sendStatusChanges();
+        break;
+    }
+
+    case CHANGE_NAME:
+        obj["id"] = player->getId();
+        obj["old_name"] = player->getName();
+        obj["new_name"] = generatePlayerName(player->getId(), obj["new_name"].toString());
+        player->setName(obj["new_name"].toString());
+        recordPlayer(player);
+        sendMessageToAllPlayers(obj);
+        sendStatusChanges();
+        break;
+
+    case SET_FOCUS: {
+        // -1 when the player has no square focused
+        int position = obj["pos"].toInt(-2);
+        if (position < -1 || position >= 81) {
+            break;
+        }
+        recorder.focus(player->getId(), position);
+        QString team = player->getTeam();
+        std::vector<Player *> list_players;
+        for (auto p : players) {
+            if (p.second->getTeam() == team && p.second.get() != player) {
+                list_players.push_back(p.second.get());
+            }
+        }
+        if (!list_players.empty()) {
+            sendMessageToPlayers(obj, list_players);
+        }
+        break;
+    }
+
+    case CHANGE_TEAM: {
+        QString team = obj["team"].toString();
+        if (player->getTeam() != team) {
+            assign_team(player, team, true);
+            if (active) {
+                obj = sendBoard(mode == COOP ? team : "");
+                sendMessageToPlayer(obj, player);
+
+                QJsonObject unfocus;
+                unfocus["message"] = SET_FOCUS;
+                unfocus["id"] = player->getId();
+                unfocus["pos"] = -1;
+                sendMessageToAllPlayers(unfocus, player);
+            }
+
+            sendStatusChanges();
+        }
+        break;
+    }
+
+    case UPDATE_NOTES: {
+        // kept by the server, the journal and the recording, so checked before anything is stored
+        int position = obj["pos"].toInt(-1);
+        if (position < 0 || position >= 81) {
+            break;
+        }
+
+        // each note once, in order, whatever the client sent
+        quint16 mask = 0;
+        for (auto note : obj["notes"].toArray()) {
+            int value = note.toInt();
+            if (value >= 1 && value <= 9) {
+                mask |= 1 << (value - 1);
+            }
+        }
+
+        std::vector<int> &team_notes = notes[player->getTeam()][position];
+        team_notes.clear();
+        QJsonArray list;
+        for (int value = 1; value <= 9; ++value) {
+            if (mask & (1 << (value - 1))) {
+                team_notes.push_back(value);
+                list.append(value);
             }
         }
+        obj["notes"] = list;
+
+        recorder.notes(player->getId(), position, team_notes);
+        if (journal) {
+            journal->notes(player->getTeam(), position, team_notes);
+        }
+        if (mode == COOP) {
+            auto players = listPlayersInTeam(player->getTeam(), player);
+            sendMessageToPlayers(obj, players);
+        }
+        break;
+    }
+
+    case PONG: {
+        // measured from our own clock: only the answer to the last PING counts, its "ts" is just checked
+        Connection &connection = connections[player];
+        if (connection.ping_sent < 0 || static_cast<qint64>(obj["ts"].toDouble(-1)) != connection.ping_sent) {
+            break;
+        }
+        connection.latency = static_cast<int>(clock.elapsed() - connection.ping_sent);
+        connection.ping_sent = -1;
+        break;
+    }
     }
 }
 }
@@ -20,12 +20,19 @@
 #define GAME_H
 
 #include "constants.h"
+#include "journal.h"
+#include "metrics.h"
 #include "player.h"
+#include "puzzlebank.h"
+#include "recorder.h"
 #include "sudoku.h"
 
+#include <QElapsedTimer>
 #include <QTcpServer>
+#include <QTimer>
 #include <QJsonObject>
 
+#include <deque>
 #include <map>
 #include <memory>
 #include <vector>
@@ -58,23 +65,154 @@ public:
      */
     void start_game(SB::Difficulty, GameMode);
 
+    /**
+     * @brief starts a game with a known puzzle
+     * @param puzzle the puzzle
+     * @param solution its solution
+     * @param mode single player or coop
+     * @return false if the puzzle does not have exactly one solution, or if it is not the one given
+     */
+    bool start_game(const std::vector<int> &, const std::vector<int> &, GameMode);
+
     /**
      * @brief sets the team list available to players
      * @param teams the list of team names
      */
     void setTeamNames(QStringList);
 
+    /**
+     * @brief exposes the server metrics over HTTP on the loopback interface
+     * @param port the port of the metrics endpoint
+     * @return true if the endpoint is listening
+     */
+    bool start_metrics(quint16);
+
+    /**
+     * @brief journals every state change to a directory, restoring the game it holds first
+     * must be called after setTeamNames and before players connect
+     * @param directory where the journal and its snapshots are stored
+     * @return true if a game was restored
+     */
+    bool start_journal(const QString &);
+
+    /**
+     * @brief records every game started from now on in a directory, an empty directory disables it
+     * @param directory where the recordings are written
+     */
+    void setRecordingDirectory(const QString &);
+
+    /**
+     * @brief starts games with puzzles from a bank instead of generating them, an empty path disables it
+     * difficulties missing from the bank are still generated
+     * @param path the puzzle bank
+     * @return false if the bank could not be opened
+     */
+    bool setPuzzleBank(const QString &);
+
+    /**
+     * @brief registers a client socket, as if it just connected to the server
+     * @param socket the client's socket
+     * @return the new player
+     */
+    Player *addPlayer(QTcpSocket *);
+
+    /**
+     * @brief handle a single message received from a player
+     * @param player the player who sent the message
+     * @param obj the decoded message
+     */
+    void processMessage(Player *, QJsonObject &);
+
+    /**
+     * @return the server's load counters
+     */
+    const Metrics &getMetrics() const;
+
 private:
+    /**
+     * @brief state kept for a player whose connection dropped, so they can resume it
+     */
+    struct Session {
+        int id;
+        QString name;
+        QString team;
+
+        /**
+         * @brief the game_number when the player dropped
+         */
+        int game;
+
+        /**
+         * @brief the player's board (versus) or the team board they last saw (coop)
+         */
+        std::vector<int> board;
+
+        /**
+         * @brief the team notes they last saw (coop)
+         */
+        std::map<int, std::vector<int>> notes;
+
+        /**
+         * @brief when the session is forgotten, on the server's clock
+         */
+        qint64 expires;
+
+        /**
+         * @brief the client's board cannot be trusted (server restarted), send a full board on resume
+         */
+        bool resync = false;
+
+        /**
+         * @brief the sequence number of the last moves applied for the player (coop)
+         */
+        quint64 last_seq = 0;
+    };
+
+    /**
+     * @brief what the server knows about a connected player's link
+     */
+    struct Connection {
+        /**
+         * @brief last time data was received from the player, on the server's clock
+         */
+        qint64 last_seen = 0;
+
+        /**
+         * @brief round-trip time in milliseconds, -1 if unknown
+         */
+        int latency = -1;
+
+        /**
+         * @brief when the last PING was sent and not answered yet, -1 if none is
+         */
+        qint64 ping_sent = -1;
+
+        /**
+         * @brief sequence number of the last moves applied (coop), moves sent again are dropped
+         */
+        quint64 last_seq = 0;
+    };
+
     /**
      * @brief incremental ID to give to new players who connect
      */
     int current_id;
 
+    /**
+     * @brief incremented every time a game starts
+     */
+    int game_number = 0;
+
     /**
      * @brief active puzzle / game or not
      */
     bool active = false;
 
+    /**
+     * @brief a winner was announced: the board is still shown, but the game is not restored after a restart
+     */
+    bool finished = false;
+
     /**
      * @brief the current Sudoqu::GameMode (Versus or co-op)
      */
@@ -90,6 +228,16 @@ private:
      */
     std::map<QTcpSocket *, std::shared_ptr<Player>> players;
 
+    /**
+     * @brief the link of each connected player
+     */
+    std::map<Player *, Connection> connections;
+
+    /**
+     * @brief players who dropped without disconnecting, by resume token
+     */
+    std::map<QString, Session> sessions;
+
     /**
      * @brief the current Sudoqu::Sudoku
      */
@@ -100,6 +248,11 @@ private:
      */
     std::map<QString, std::vector<int>> coop_boards;
 
+    /**
+     * @brief number of changes made to each team's board, used in coop to order concurrent moves
+     */
+    std::map<QString, quint64> coop_revisions;
+
     /**
          * @brief boards for a player, used in versus
          */
@@ -110,6 +263,56 @@ private:
      */
     std::map<QString, std::map<int, std::vector<int>>> notes;
 
+    /**
+     * @brief the last CHAT_HISTORY_SIZE chat messages, sent to players who join
+     */
+    std::deque<ChatLine> chat_history;
+
+    /**
+     * @brief load counters for this server
+     */
+    Metrics metrics;
+
+    /**
+     * @brief the HTTP endpoint exposing the metrics, if enabled
+     */
+    std::unique_ptr<MetricsServer> metrics_server;
+
+    /**
+     * @brief records state changes so the game survives a restart, if enabled
+     */
+    std::unique_ptr<Journal> journal;
+
+    /**
+     * @brief where games are recorded, empty if they are not
+     */
+    QString recording_directory;
+
+    /**
+     * @brief records the current game's moves
+     */
+    Recorder recorder;
+
+    /**
+     * @brief pre-generated puzzles, if enabled
+     */
+    PuzzleBank bank;
+
+    /**
+     * @brief picks the puzzles and seeds their boards
+     */
+    Random random;
+
+    /**
+     * @brief monotonic clock used for PING timestamps and idle detection
+     */
+    QElapsedTimer clock;
+
+    /**
+     * @brief periodically pings the players and reaps the ones that stopped answering
+     */
+    QTimer heartbeat;
+
     /**
      * @brief Sends a JSON encoded message to a player
      */
@@ -160,9 +363,11 @@ private:
 
     /**
      * @brief used when we want to send the player an updated board
+     * @param team the team whose board is sent (coop)
+     * @param player the player whose board is sent (versus), only the givens are sent if null
      * @return a QJsonObject ready to be sent over the network containing the board that the player should see
      */
-    QJsonObject sendBoard(QString = "");
+    QJsonObject sendBoard(QString = "", Player * = nullptr);
 
     /**
      * @brief assign a player to a team
@@ -194,6 +399,37 @@ private:
      */
     QString generatePlayerName(int, QString);
 
+    /**
+     * @brief give a reconnecting player the id, name, team and board of a dropped session
+     * @param player the player who just reconnected
+     * @param token the resume token of the dropped session
+     * @return false if there is no such session (expired or unknown token)
+     */
+    bool resumeSession(Player *, QString);
+
+    /**
+     * @return a copy of the game state, as stored in the journal's snapshots
+     */
+    GameState saveState() const;
+
+    /**
+     * @brief replaces the game state with one restored from the journal
+     * the players it contains are kept as sessions they can resume
+     */
+    void restoreState(GameState &);
+
+    /**
+     * @brief record a player's id, name and team in the journal and the game recording
+     */
+    void recordPlayer(Player *);
+
+    /**
+     * @brief starts a game (puzzle)
+     * @param sudoku the puzzle and its solution
+     * @param mode single player or coop
+     */
+    void start_game(std::unique_ptr<Sudoku>, GameMode);
+
 private slots:
     /**
      * @brief called when a new client (socket) connected to the server
@@ -205,10 +441,21 @@ private slots:
      */
     void clientDisconnected(QTcpSocket *);
 
+    /**
+     * @brief called when a client's connection was lost without a DISCONNECT message
+     * its state is kept for RESUME_GRACE_PERIOD so the player can resume
+     */
+    void clientDropped(QTcpSocket *);
+
     /**
      * @brief read data from the socket, and dispatch the messages received
      */
     void dataReceived();
+
+    /**
+     * @brief disconnect idle players, send a PING to the others and publish their latency
+     */
+    void sendHeartbeat();
 };
 }
 
@@ -18,12 +18,15 @@
 
 #include "gameframe.h"
 
+#include "isomorph.h"
 #include "sudoku.h"
 
 #include <QGuiApplication>
 #include <QDebug>
 #include <QPainter>
 #include <QMouseEvent>
+#include <QPaintEvent>
+#include <QResizeEvent>
 #include <QKeyEvent>
 
 #include <algorithm>
@@ -33,17 +36,19 @@ namespace Sudoqu {
 GameFrame::GameFrame(QWidget *parent) : QFrame(parent), active(false) {
 }
 
-void GameFrame::newBoard(std::vector<int> &g, std::vector<int> &b, GameMode m) {
+void GameFrame::newBoard(const std::vector<int> &g, const std::vector<int> &b, GameMode m, quint64 hash) {
     focused = -1;
     given = g;
     board = b;
+    solutionHash = hash;
     active = true;
     gameOver = false;
     mode = m;
-    notes.clear();
+    notes.fill(0);
     playersFocus.clear();
+    othersFocus.fill(0);
     emit setGameMode(mode);
-    repaint();
+    update();
 }
 
 int GameFrame::getAt(int pos) const {
@@ -55,7 +60,12 @@ void GameFrame::setAt(int pos, int val, bool send_network) {
     if (send_network) {
         emit sendValue(pos, val);
     }
-    notes[pos].clear();
+    notes[static_cast<size_t>(pos)] = 0;
+    updateCell(pos);
+
+    if (val > 0 && solutionHash != 0 && !gameOver && std::find(board.begin(), board.end(), 0) == board.end()) {
+        emit boardCompleted(Isomorph::hash(board) == solutionHash);
+    }
 }
 
 int GameFrame::getGivenAt(int pos) const {
@@ -66,7 +76,7 @@ void GameFrame::stop() {
     board.clear();
     given.clear();
     active = false;
-    repaint();
+    update();
 }
 
 bool GameFrame::isGameActive() const {
@@ -89,60 +99,127 @@ void GameFrame::cheat() {
         }
     }
 
-    emit sendValues(board);
-    repaint();
+    emit sendValues(toCells(board));
+    update();
     gameOver = true;
 }
 
 void GameFrame::clearBoard() {
     board = given;
     focused = -1;
-    emit sendValues(board);
-    repaint();
+    emit sendValues(toCells(board));
+    update();
 }
 
-void GameFrame::otherPlayerValues(std::map<int, int> &values) {
-    for (auto value : values) {
-        setAt(value.first, value.second, false);
+void GameFrame::otherPlayerValues(const CellChanges &values) {
+    for (int pos = 0; pos < 81; ++pos) {
+        if (values.has(pos)) {
+            setAt(pos, values.at(pos), false);
+        }
     }
-    repaint();
 }
 
 void GameFrame::otherPlayerFocus(int id, int pos) {
-    if (pos == -1) {
-        playersFocus.erase(id);
-    } else {
+    auto previous = playersFocus.find(id);
+    if (previous != playersFocus.end()) {
+        if (previous->second >= 0 && previous->second < 81) {
+            --othersFocus[static_cast<size_t>(previous->second)];
+        }
+        updateCell(previous->second);
+        playersFocus.erase(previous);
+    }
+
+    if (pos >= 0 && pos < 81) {
         playersFocus[id] = pos;
+        ++othersFocus[static_cast<size_t>(pos)];
     }
-    repaint();
+    updateCell(pos);
 }
 
 void GameFrame::gameOverWinner() {
     gameOver = true;
+    updateCell(focused);
     focused = -1;
-    repaint();
 }
 
 void GameFrame::setColorTheme(ColorTheme theme) {
-    this->colors = theme;
+    palette = ColorPalette(theme);
+    cache.invalidate();
 }
 
-void GameFrame::receivedNotes(int pos, std::vector<int> &notes) {
-    this->notes[pos] = notes;
-    repaint();
+void GameFrame::receivedNotes(int pos, Notes notes) {
+    if (pos < 0 || pos >= 81) {
+        return;
+    }
+
+    this->notes[static_cast<size_t>(pos)] = static_cast<Notes>(notes & 0x1ff);
+    updateCell(pos);
+}
+
+std::vector<int> GameFrame::getNotes(int pos) const {
+    std::vector<int> list;
+    for (int note = 1; note <= 9; ++note) {
+        if (notes[static_cast<size_t>(pos)] & (1 << (note - 1))) {
+            list.push_back(note);
+        }
+    }
+    return list;
 }
 
 void GameFrame::clearNotes() {
-    notes.clear();
-    repaint();
+    notes.fill(0);
+    update();
 }
 
 void GameFrame::setNotesEnabled(bool enabled) {
     notesEnabled = enabled;
-    repaint();
+    update();
+}
+
+QRect GameFrame::cellRect(int pos) const {
+    int width = geometry().size().width() / 9;
+    int height = geometry().size().height() / 9;
+    return QRect((pos % 9) * width, (pos / 9) * height, width, height);
+}
+
+void GameFrame::updateCell(int pos) {
+    if (pos < 0 || pos >= 81) {
+        return;
+    }
+    // the grid lines are centered on the borders, include the part drawn over the neighbours
+    update(cellRect(pos).adjusted(-3, -3, 3, 3));
+}
+
+void GameFrame::setRenderCacheEnabled(bool enabled) {
+    cacheEnabled = enabled;
+    cache.invalidate();
+    update();
+}
+
+void GameFrame::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    paintBoard(painter, event->region());
+}
+
+void GameFrame::resizeEvent(QResizeEvent *event) {
+    cache.invalidate();
+    QFrame::resizeEvent(event);
+}
+
+QFont GameFrame::boardFont(bool forNotes) const {
+    int fontSize = 30;
+    if (geometry().size().width() < 500 || geometry().size().height() < 500) {
+        fontSize = 12;
+    }
+
+    QFont font("Ubuntu", fontSize);
+    if (forNotes) {
+        font.setPixelSize(10);
+    }
+    return font;
 }
 
-void GameFrame::paintEvent(QPaintEvent *) {
+void GameFrame::paintBoard(QPainter &painter, const QRegion &region) {
     if (!active) {
         return;
     }
@@ -156,70 +233,58 @@ void GameFrame::paintEvent(QPaintEvent *) {
     int width = window_width / cols;
     int height = window_height / rows;
 
-    QPainter painter(this);
-
-    QBrush brush(Qt::SolidPattern);
-
-    int fontSize = 30;
-    if (window_width < 500 || window_height < 500) {
-        fontSize = 12;
-    }
-
-    int noteFontSize = 10;
-
-    QFont font("Ubuntu", fontSize);
-    painter.setFont(font);
     painter.setRenderHint(QPainter::Antialiasing);
 
-    QFont fontNotes = font;
-    fontNotes.setPixelSize(noteFontSize);
-
-    std::map<int, bool> otherFocus;
-    if (!playersFocus.empty()) {
-        for (auto f : playersFocus) {
-            if (f.second > -1) {
-                otherFocus[f.second] = true;
-            }
+    QFont font;
+    QFont fontNotes;
+    if (cacheEnabled) {
+        if (!cache.isValid(size(), devicePixelRatioF())) {
+            cache.rebuild(size(), devicePixelRatioF(), palette, boardFont(false), boardFont(true));
         }
+    } else {
+        font = boardFont(false);
+        fontNotes = boardFont(true);
     }
 
-    QPen pen;
-
     for (int row = 0; row < rows; ++row) {
         for (int col = 0; col < cols; ++col) {
             int pos = row * rows + col;
             QRect rect(col * width, row * height, width, height);
+            if (!region.intersects(rect)) {
+                continue;
+            }
             int valueGiven = this->getGivenAt(pos);
             int value = this->getAt(pos);
 
-            QColor bg;
-            QColor fg;
-
+            ColorPalette::Role role;
             if (valueGiven > 0) {
-                bg = colors.given_background;
-                fg = colors.given_foreground;
+                role = ColorPalette::GIVEN;
             } else if (pos == focused) {
-                bg = colors.focus_background;
-                fg = colors.focus_foreground;
+                role = ColorPalette::FOCUS;
             } else if (value > 0) {
-                bg = colors.filled_background;
-                fg = colors.filled_foreground;
-            } else if (otherFocus[pos]) {
-                bg = colors.other_focus_background;
-                fg = colors.other_focus_foreground;
+                role = ColorPalette::FILLED;
+            } else if (othersFocus[static_cast<size_t>(pos)] > 0) {
+                role = ColorPalette::OTHER_FOCUS;
             } else {
-                bg = colors.background;
-                fg = colors.foreground;
+                role = ColorPalette::EMPTY;
             }
 
-            pen.setColor(fg);
-            painter.fillRect(rect, bg);
-            painter.setPen(pen);
+            painter.fillRect(rect, palette.background[role]);
+
+            Notes notes_pos = notes[static_cast<size_t>(pos)];
+            if (notesEnabled && notes_pos != 0) {
+                if (cacheEnabled) {
+                    for (int note = 1; note <= 9; ++note) {
+                        if (notes_pos & (1 << (note - 1))) {
+                            cache.drawNote(painter, rect, note, role);
+                        }
+                    }
+                    continue;
+                }
 
-            std::vector<int> &notes_pos = notes[pos];
-            if (notesEnabled && !notes_pos.empty()) {
+                painter.setPen(palette.foreground[role]);
                 painter.setFont(fontNotes);
-                for (auto note : notes_pos) {
+                for (auto note : getNotes(pos)) {
                     QString text = QString::number(note);
                     note--;
                     int note_width = width / 3;
@@ -235,6 +300,12 @@ void GameFrame::paintEvent(QPaintEvent *) {
                 }
 
             } else if (value > 0) {
+                if (cacheEnabled) {
+                    cache.drawValue(painter, rect, value, role);
+                    continue;
+                }
+
+                painter.setPen(palette.foreground[role]);
                 painter.setFont(font);
                 QString text = QString::number(value);
                 painter.drawText(rect, Qt::AlignVCenter | Qt::AlignCenter, text);
@@ -242,28 +313,10 @@ void GameFrame::paintEvent(QPaintEvent *) {
         }
     }
 
-    QPen outer_lines;
-    outer_lines.setColor(colors.outer_lines);
-    outer_lines.setWidth(5);
-
-    QPen inner_lines;
-    inner_lines.setColor(colors.inner_lines);
-    inner_lines.setWidth(1);
-
-    for (int i = 0; i <= rows; ++i) {
-        painter.setPen(inner_lines);
-        if (i % 3 == 0) {
-            painter.setPen(outer_lines);
-        }
-        painter.drawLine(width * i, 0, width * i, height * rows);
-    }
-
-    for (int i = 0; i <= cols; ++i) {
-        painter.setPen(inner_lines);
-        if (i % 3 == 0) {
-            painter.setPen(outer_lines);
-        }
-        painter.drawLine(0, height * i, width * cols, height * i);
+    if (cacheEnabled) {
+        painter.drawPixmap(0, 0, cache.grid());
+    } else {
+        RenderCache::drawGrid(painter, width, height, palette);
     }
 }
 
@@ -288,6 +341,8 @@ void GameFrame::mouseReleaseEvent(QMouseEvent *event) {
 
     int pos = row * 9 + col;
 
+    updateCell(focused);
+
     if (getGivenAt(pos) > 0) {
         focused = -1;
     } else {
@@ -298,7 +353,7 @@ void GameFrame::mouseReleaseEvent(QMouseEvent *event) {
         emit sendFocusedSquare(focused);
     }
 
-    repaint();
+    updateCell(focused);
 }
 
 void GameFrame::keyPressEvent(QKeyEvent *event) {
@@ -318,6 +373,8 @@ void GameFrame::keyPressEvent(QKeyEvent *event) {
         return;
     }
 
+    updateCell(focused);
+
     if (key == Qt::Key_Right || key == Qt::Key_Left || key == Qt::Key_Down || key == Qt::Key_Up) {
         int old_focus = focused;
 
@@ -350,9 +407,9 @@ void GameFrame::keyPressEvent(QKeyEvent *event) {
             if (!takingNotes || !notesEnabled) {
                 setAt(focused, 0, true);
             } else {
-                notes[focused].clear();
+                notes[static_cast<size_t>(focused)] = 0;
                 if (mode == COOP) {
-                    emit sendNotes(focused, notes[focused]);
+                    emit sendNotes(focused, 0);
                 }
             }
         } else if (key == Qt::Key_Escape) {
@@ -366,23 +423,15 @@ void GameFrame::keyPressEvent(QKeyEvent *event) {
                     if (getAt(focused) > 0) {
                         return;
                     }
-                    std::vector<int> &notes_pos = notes[focused];
-
-                    auto iterator = std::find(notes_pos.begin(), notes_pos.end(), check->second);
-                    if (iterator == notes_pos.end()) {
-                        notes_pos.push_back(check->second);
-                        std::sort(notes_pos.begin(), notes_pos.end());
-                    } else {
-                        notes_pos.erase(iterator);
-                    }
+                    notes[static_cast<size_t>(focused)] ^= 1 << (check->second - 1);
                     if (mode == COOP) {
-                        emit sendNotes(focused, notes_pos);
+                        emit sendNotes(focused, notes[static_cast<size_t>(focused)]);
                     }
                 }
             }
         }
     }
-    repaint();
+    updateCell(focused);
 }
 
 int GameFrame::moveFocus(int delta, bool moving_row) {
@@ -19,11 +19,14 @@
 #ifndef SUDOQU_GAMEFRAME_H
 #define SUDOQU_GAMEFRAME_H
 
+#include "cells.h"
 #include "constants.h"
 #include "colortheme.h"
+#include "rendercache.h"
 
 #include <QFrame>
 
+#include <array>
 #include <map>
 #include <vector>
 
@@ -34,7 +37,14 @@ class GameFrame : public QFrame {
 public:
     GameFrame(QWidget * = nullptr);
 
-    void newBoard(std::vector<int> &, std::vector<int> &, GameMode);
+    /**
+     * @brief starts a new board
+     * @param given the givens
+     * @param board the values entered so far
+     * @param mode the game mode
+     * @param solution_hash the hash of the solution, 0 if unknown
+     */
+    void newBoard(const std::vector<int> &, const std::vector<int> &, GameMode, quint64 = 0);
     void stop();
 
     int getAt(int) const;
@@ -44,39 +54,71 @@ public:
     bool isGameActive() const;
     void cheat();
     void clearBoard();
-    void otherPlayerValues(std::map<int, int> &);
+    void otherPlayerValues(const CellChanges &);
     void otherPlayerFocus(int, int);
     void gameOverWinner();
     void setColorTheme(ColorTheme);
-    void receivedNotes(int, std::vector<int> &);
+    void receivedNotes(int, Notes);
     void clearNotes();
     void setNotesEnabled(bool);
 
+    /**
+     * @brief paints the board, used by paintEvent and to render it off screen
+     * @param painter the painter
+     * @param region only the squares in this region are painted
+     */
+    void paintBoard(QPainter &, const QRegion &);
+
+    /**
+     * @brief switches between the pre-rendered grid and digits and drawing everything on each paint
+     */
+    void setRenderCacheEnabled(bool);
+
 signals:
     void sendFocusedSquare(int);
     void setGameMode(GameMode);
     void sendValue(int = -1, int = -1);
-    void sendValues(std::vector<int> &);
-    void sendNotes(int, std::vector<int> &);
+    void sendValues(const Cells &);
+    void sendNotes(int, Notes);
     void toggleTakingNotes(QString);
 
+    /**
+     * @brief emitted when the last empty square is filled
+     * @param solved true if the board matches the solution hash sent by the server
+     */
+    void boardCompleted(bool);
+
 protected:
     void paintEvent(QPaintEvent *) override;
     void mouseReleaseEvent(QMouseEvent *) override;
     void keyPressEvent(QKeyEvent *) override;
+    void resizeEvent(QResizeEvent *) override;
 
 private:
     bool active;
     bool gameOver;
     std::vector<int> board;
     std::vector<int> given;
-    std::map<int, std::vector<int>> notes;
+    quint64 solutionHash = 0;
+
+    /**
+     * @brief the notes of each square, bit n - 1 is set for note n
+     */
+    std::array<Notes, 81> notes{};
 
     GameMode mode;
     int focused = -1;
 
+    /**
+     * @brief the square focused by each other player, by id
+     */
     std::map<int, int> playersFocus;
 
+    /**
+     * @brief how many other players are focused on each square
+     */
+    std::array<quint8, 81> othersFocus{};
+
     std::map<int, int> key_map = {
         {Qt::Key_1, 1}, {Qt::Key_2, 2}, {Qt::Key_3, 3}, {Qt::Key_4, 4}, {Qt::Key_5, 5},
         {Qt::Key_6, 6}, {Qt::Key_7, 7}, {Qt::Key_8, 8}, {Qt::Key_9, 9},
@@ -84,11 +126,34 @@ private:
 
     int moveFocus(int, bool);
 
-    ColorTheme colors;
+    /**
+     * @return the font of the values, or of the notes, for the current size
+     */
+    QFont boardFont(bool) const;
+
+    /**
+     * @return the notes of a square, in order
+     */
+    std::vector<int> getNotes(int) const;
+
+    /**
+     * @return the area of the widget covered by a square
+     */
+    QRect cellRect(int) const;
+
+    /**
+     * @brief schedules a repaint of a single square, coalesced by Qt with the other pending updates
+     */
+    void updateCell(int);
+
+    ColorPalette palette;
 
     bool takingNotes = false;
 
     bool notesEnabled = false;
+
+    RenderCache cache;
+    bool cacheEnabled = true;
 };
 }
 
@@ -0,0 +1,161 @@
+/*
+ * generator.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "generator.h"
+#include "grader.h"
+#include "isomorph.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Sudoqu {
+
+namespace {
+const int BOARD_SIZE = 81;
+
+/**
+ * @brief clues put back each time a puzzle comes out too easy
+ */
+const int RESTORED_CLUES = 3;
+
+/**
+ * @brief refinements tried on a grid before starting over from a new one
+ */
+const int MAX_REFINES = 40;
+}
+
+Generator::Generator(Random &random) : random(random) {
+}
+
+void Generator::generate(SB::Difficulty difficulty, int givens) {
+    // no puzzle is ever rated outside of these, the loop below would never end
+    if (difficulty < SB::SIMPLE) {
+        difficulty = SB::SIMPLE;
+    } else if (difficulty > SB::EXPERT) {
+        difficulty = SB::EXPERT;
+    }
+
+    while (true) {
+        std::vector<bool> restored(BOARD_SIZE, false);
+        fillGrid();
+        puzzle = solution;
+        dig(difficulty, givens, restored);
+
+        for (int refine = 0; refine < MAX_REFINES; ++refine) {
+            SB::Difficulty rating = rate();
+            if (rating == difficulty) {
+                return;
+            }
+            if (rating > difficulty) {
+                // only when the puzzle could not be dug without going past the difficulty
+                break;
+            }
+
+            // the clues put back stay, so the next dig ends on a different puzzle
+            restore(RESTORED_CLUES, restored);
+            dig(difficulty, givens, restored);
+        }
+
+        // the difficulty may be out of reach with that many givens
+        givens = std::max(0, givens - 1);
+    }
+}
+
+const std::vector<int> &Generator::getPuzzle() const {
+    return puzzle;
+}
+
+const std::vector<int> &Generator::getSolution() const {
+    return solution;
+}
+
+void Generator::fillGrid() {
+    // the diagonal boxes share no row or column, any digits there can be completed
+    std::vector<int> grid(BOARD_SIZE, 0);
+    std::vector<int> digits(9);
+    for (int box = 0; box < 3; ++box) {
+        std::iota(digits.begin(), digits.end(), 1);
+        shuffle(digits);
+        for (int i = 0; i < 9; ++i) {
+            grid[static_cast<size_t>((box * 3 + i / 3) * 9 + box * 3 + i % 3)] = digits[static_cast<size_t>(i)];
+        }
+    }
+
+    // the solver always completes it the same way, the shuffle spreads grids over all the others
+    Solver solver(grid);
+    solver.countSolutions(1);
+    solution = Isomorph(random.next()).apply(solver.getSolution());
+}
+
+void Generator::dig(SB::Difficulty difficulty, int givens, const std::vector<bool> &keep) {
+    std::vector<int> order;
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        if (puzzle[static_cast<size_t>(pos)] != 0 && !keep[static_cast<size_t>(pos)]) {
+            order.push_back(pos);
+        }
+    }
+    shuffle(order);
+
+    int count = static_cast<int>(std::count_if(puzzle.begin(), puzzle.end(), [](int value) { return value > 0; }));
+    for (int pos : order) {
+        if (count <= givens) {
+            break;
+        }
+
+        int &square = puzzle[static_cast<size_t>(pos)];
+        int value = square;
+        square = 0;
+
+        // the hardest difficulty has no ceiling, its puzzles are only graded once dug
+        if (Solver(puzzle).countSolutions() != 1 || (difficulty < SB::EXPERT && rate() > difficulty)) {
+            square = value;
+        } else {
+            --count;
+        }
+    }
+}
+
+void Generator::restore(int count, std::vector<bool> &restored) {
+    std::vector<int> empty;
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        if (puzzle[static_cast<size_t>(pos)] == 0) {
+            empty.push_back(pos);
+        }
+    }
+    shuffle(empty);
+
+    std::fill(restored.begin(), restored.end(), false);
+    for (size_t i = 0; i < empty.size() && i < static_cast<size_t>(count); ++i) {
+        size_t pos = static_cast<size_t>(empty[i]);
+        puzzle[pos] = solution[pos];
+        restored[pos] = true;
+    }
+}
+
+SB::Difficulty Generator::rate() const {
+    Grader grader(puzzle);
+    return Sudoku::difficulty(grader.grade());
+}
+
+template <typename T> void Generator::shuffle(std::vector<T> &items) {
+    for (size_t i = items.size(); i > 1; --i) {
+        std::swap(items[i - 1], items[random.below(static_cast<std::uint32_t>(i))]);
+    }
+}
+}
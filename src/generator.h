@@ -0,0 +1,94 @@
+/*
+ * generator.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_GENERATOR_H
+#define SUDOQU_GENERATOR_H
+
+#include "random.h"
+#include "sudoku.h"
+
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class Generator
+ * @brief Makes puzzles of a given difficulty by removing clues from a full grid
+ *
+ * Clues are removed in a random order, each removal kept only if the puzzle still has a
+ * unique solution and is not harder than wanted. When no clue can be removed and the
+ * puzzle is still too easy, a few clues are put back and others are removed in their
+ * place, so the same grid is refined instead of a new puzzle being generated from scratch.
+ */
+class Generator {
+public:
+    /**
+     * @param random the generator choosing the grid and the clues removed
+     */
+    explicit Generator(Random &);
+
+    /**
+     * @brief generates a puzzle with a unique solution
+     * @param difficulty the difficulty wanted, see Sudoku::difficulty, UNKNOWN is made SIMPLE
+     * @param givens stop removing clues at this many givens, 0 to remove as many as possible,
+     * lowered when the difficulty cannot be reached with that many
+     */
+    void generate(SB::Difficulty, int = 0);
+
+    /**
+     * @return the puzzle generated
+     */
+    const std::vector<int> &getPuzzle() const;
+
+    /**
+     * @return the solution to the puzzle generated
+     */
+    const std::vector<int> &getSolution() const;
+
+private:
+    Random &random;
+    std::vector<int> puzzle;
+    std::vector<int> solution;
+
+    /**
+     * @brief fills solution with a new random grid
+     */
+    void fillGrid();
+
+    /**
+     * @brief removes clues in a random order while the puzzle stays unique and not too hard
+     * @param difficulty the hardest difficulty allowed
+     * @param givens the fewest givens allowed
+     * @param keep squares whose clue must stay
+     */
+    void dig(SB::Difficulty, int, const std::vector<bool> &);
+
+    /**
+     * @brief puts back clues removed earlier
+     * @param count the number of clues to put back
+     * @param restored marks the squares put back
+     */
+    void restore(int, std::vector<bool> &);
+
+    SB::Difficulty rate() const;
+
+    template <typename T> void shuffle(std::vector<T> &);
+};
+}
+
+#endif
@@ -0,0 +1,443 @@
+/*
+ * grader.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grader.h"
+#include "solver.h"
+#include "units.h"
+
+#include <algorithm>
+
+namespace Sudoqu {
+
+namespace {
+const int BOARD_SIZE = 81;
+
+/**
+ * @brief the longest chain of squares followed by xyChain()
+ */
+const int MAX_CHAIN = 6;
+}
+
+const char *techniqueName(Technique technique) {
+    switch (technique) {
+    case NO_TECHNIQUE:
+        return "none";
+    case HIDDEN_SINGLE:
+        return "hidden single";
+    case NAKED_SINGLE:
+        return "naked single";
+    case LOCKED_CANDIDATES:
+        return "locked candidates";
+    case NAKED_PAIR:
+        return "naked pair";
+    case X_WING:
+        return "x-wing";
+    case HIDDEN_PAIR:
+        return "hidden pair";
+    case XY_CHAIN:
+        return "xy-chain";
+    case GUESSING:
+        return "guessing";
+    }
+    return "unknown";
+}
+
+Grader::Grader(const std::vector<int> &puzzle) {
+    candidates.fill(ALL_DIGITS);
+    empty = BOARD_SIZE;
+
+    for (int pos = 0; pos < BOARD_SIZE && static_cast<size_t>(pos) < puzzle.size(); ++pos) {
+        int value = puzzle[static_cast<size_t>(pos)];
+        if (value >= 1 && value <= 9) {
+            place(pos, value);
+        }
+    }
+}
+
+int Grader::cost(Technique technique) {
+    switch (technique) {
+    case NO_TECHNIQUE:
+        return 0;
+    case HIDDEN_SINGLE:
+        return 12;
+    case NAKED_SINGLE:
+        return 23;
+    case LOCKED_CANDIDATES:
+        return 26;
+    case NAKED_PAIR:
+        return 30;
+    case X_WING:
+        return 32;
+    case HIDDEN_PAIR:
+        return 34;
+    case XY_CHAIN:
+        return 42;
+    case GUESSING:
+        return 100;
+    }
+    return 0;
+}
+
+Grade Grader::grade() {
+    Grade result;
+
+    while (empty > 0) {
+        Technique used = HIDDEN_SINGLE;
+        int count = hiddenSingles();
+
+        if (count == 0) {
+            used = NAKED_SINGLE;
+            count = nakedSingles();
+        }
+
+        if (count == 0) {
+            count = 1;
+            if (lockedCandidates()) {
+                used = LOCKED_CANDIDATES;
+            } else if (nakedPairs()) {
+                used = NAKED_PAIR;
+            } else if (xWing()) {
+                used = X_WING;
+            } else if (hiddenPairs()) {
+                used = HIDDEN_PAIR;
+            } else if (xyChain()) {
+                used = XY_CHAIN;
+            } else if (guess()) {
+                used = GUESSING;
+            } else {
+                // the puzzle has no solution
+                break;
+            }
+        }
+
+        result.steps += count;
+        result.rating += count * cost(used);
+        result.hardest = std::max(result.hardest, used);
+    }
+
+    return result;
+}
+
+void Grader::place(int pos, int digit) {
+    std::uint16_t bit = digitBit(digit);
+    cells[pos] = static_cast<std::uint8_t>(digit);
+    candidates[pos] = 0;
+    --empty;
+
+    for (int peer : boardUnits().peers[pos]) {
+        candidates[peer] &= static_cast<std::uint16_t>(~bit);
+    }
+}
+
+bool Grader::eliminate(int pos, std::uint16_t bit) {
+    if (cells[pos] || !(candidates[pos] & bit)) {
+        return false;
+    }
+    candidates[pos] &= static_cast<std::uint16_t>(~bit);
+    return true;
+}
+
+int Grader::hiddenSingles() {
+    int placed = 0;
+
+    for (auto &unit : boardUnits().units) {
+        std::uint16_t once = 0, twice = 0;
+        for (int pos : unit) {
+            twice = static_cast<std::uint16_t>(twice | (once & candidates[pos]));
+            once |= candidates[pos];
+        }
+
+        std::uint16_t hidden = static_cast<std::uint16_t>(once & ~twice);
+        while (hidden) {
+            std::uint16_t bit = static_cast<std::uint16_t>(hidden & -hidden);
+            hidden = static_cast<std::uint16_t>(hidden ^ bit);
+            for (int pos : unit) {
+                if (candidates[pos] & bit) {
+                    place(pos, lowestDigit(bit));
+                    ++placed;
+                    break;
+                }
+            }
+        }
+    }
+    return placed;
+}
+
+int Grader::nakedSingles() {
+    int placed = 0;
+
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        if (!cells[pos] && popcount(candidates[pos]) == 1) {
+            place(pos, lowestDigit(candidates[pos]));
+            ++placed;
+        }
+    }
+    return placed;
+}
+
+bool Grader::lockedCandidates() {
+    const BoardUnits &t = boardUnits();
+
+    for (int digit = 1; digit <= 9; ++digit) {
+        std::uint16_t bit = digitBit(digit);
+
+        // pointing: the digit is on a single line within a box, so not on the rest of that line
+        for (int b = 0; b < 9; ++b) {
+            unsigned rows = 0, cols = 0;
+            for (int pos : t.units[18 + b]) {
+                if (candidates[pos] & bit) {
+                    rows |= 1u << t.row[pos];
+                    cols |= 1u << t.col[pos];
+                }
+            }
+
+            bool changed = false;
+            if (popcount(static_cast<std::uint16_t>(rows)) == 1) {
+                for (int pos : t.units[__builtin_ctz(rows)]) {
+                    changed = (t.box[pos] != b && eliminate(pos, bit)) || changed;
+                }
+            }
+            if (popcount(static_cast<std::uint16_t>(cols)) == 1) {
+                for (int pos : t.units[9 + __builtin_ctz(cols)]) {
+                    changed = (t.box[pos] != b && eliminate(pos, bit)) || changed;
+                }
+            }
+            if (changed) {
+                return true;
+            }
+        }
+
+        // claiming: the digit is in a single box within a line, so not on the rest of that box
+        for (int line = 0; line < 18; ++line) {
+            unsigned boxes = 0;
+            for (int pos : t.units[line]) {
+                if (candidates[pos] & bit) {
+                    boxes |= 1u << t.box[pos];
+                }
+            }
+
+            if (popcount(static_cast<std::uint16_t>(boxes)) == 1) {
+                bool changed = false;
+                for (int pos : t.units[18 + __builtin_ctz(boxes)]) {
+                    bool on_line = line < 9 ? t.row[pos] == line : t.col[pos] == line - 9;
+                    changed = (!on_line && eliminate(pos, bit)) || changed;
+                }
+                if (changed) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool Grader::nakedPairs() {
+    for (auto &unit : boardUnits().units) {
+        for (int i = 0; i < 9; ++i) {
+            std::uint16_t pair = candidates[unit[i]];
+            if (popcount(pair) != 2) {
+                continue;
+            }
+            for (int j = i + 1; j < 9; ++j) {
+                if (candidates[unit[j]] != pair) {
+                    continue;
+                }
+
+                bool changed = false;
+                for (int k = 0; k < 9; ++k) {
+                    if (k != i && k != j) {
+                        for (std::uint16_t rest = pair; rest; rest = static_cast<std::uint16_t>(rest & (rest - 1))) {
+                            changed = eliminate(unit[k], static_cast<std::uint16_t>(rest & -rest)) || changed;
+                        }
+                    }
+                }
+                if (changed) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool Grader::xWing() {
+    const BoardUnits &t = boardUnits();
+
+    for (int digit = 1; digit <= 9; ++digit) {
+        std::uint16_t bit = digitBit(digit);
+
+        // lines are the rows then the columns, and the squares of a line are indexed across it
+        for (int group = 0; group < 2; ++group) {
+            unsigned where[9];
+            for (int i = 0; i < 9; ++i) {
+                where[i] = 0;
+                for (int k = 0; k < 9; ++k) {
+                    if (candidates[t.units[group * 9 + i][k]] & bit) {
+                        where[i] |= 1u << k;
+                    }
+                }
+            }
+
+            for (int i1 = 0; i1 < 9; ++i1) {
+                if (popcount(static_cast<std::uint16_t>(where[i1])) != 2) {
+                    continue;
+                }
+                for (int i2 = i1 + 1; i2 < 9; ++i2) {
+                    if (where[i2] != where[i1]) {
+                        continue;
+                    }
+
+                    bool changed = false;
+                    for (unsigned across = where[i1]; across; across &= across - 1) {
+                        int cross = (1 - group) * 9 + __builtin_ctz(across);
+                        for (int k = 0; k < 9; ++k) {
+                            if (k != i1 && k != i2) {
+                                changed = eliminate(t.units[cross][k], bit) || changed;
+                            }
+                        }
+                    }
+                    if (changed) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool Grader::hiddenPairs() {
+    for (auto &unit : boardUnits().units) {
+        unsigned where[9];
+        for (int d = 0; d < 9; ++d) {
+            where[d] = 0;
+            for (int k = 0; k < 9; ++k) {
+                if (candidates[unit[k]] & (1u << d)) {
+                    where[d] |= 1u << k;
+                }
+            }
+        }
+
+        for (int d1 = 0; d1 < 9; ++d1) {
+            if (popcount(static_cast<std::uint16_t>(where[d1])) != 2) {
+                continue;
+            }
+            for (int d2 = d1 + 1; d2 < 9; ++d2) {
+                if (where[d2] != where[d1]) {
+                    continue;
+                }
+
+                std::uint16_t pair = static_cast<std::uint16_t>((1u << d1) | (1u << d2));
+                bool changed = false;
+                for (unsigned squares = where[d1]; squares; squares &= squares - 1) {
+                    int pos = unit[__builtin_ctz(squares)];
+                    if (candidates[pos] != pair) {
+                        candidates[pos] = pair;
+                        changed = true;
+                    }
+                }
+                if (changed) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool Grader::xyChain() {
+    for (int start = 0; start < BOARD_SIZE; ++start) {
+        std::uint16_t mask = candidates[start];
+        if (popcount(mask) != 2) {
+            continue;
+        }
+
+        for (std::uint16_t rest = mask; rest; rest = static_cast<std::uint16_t>(rest & (rest - 1))) {
+            // if the start square is not this digit, it is the other one, and so on along the chain
+            int digit = lowestDigit(rest);
+            int other = lowestDigit(static_cast<std::uint16_t>(mask & ~digitBit(digit)));
+
+            std::array<bool, 81> visited{};
+            visited[start] = true;
+            if (followChain(start, digit, start, other, visited, MAX_CHAIN)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Grader::followChain(int start, int digit, int pos, int on, std::array<bool, 81> &visited, int depth) {
+    std::uint16_t on_bit = digitBit(on);
+
+    for (int next : boardUnits().peers[pos]) {
+        std::uint16_t mask = candidates[next];
+        if (visited[next] || popcount(mask) != 2 || !(mask & on_bit)) {
+            continue;
+        }
+
+        int forced = lowestDigit(static_cast<std::uint16_t>(mask & ~on_bit));
+        if (forced == digit) {
+            // either the start square or this one is the digit, so no square seeing both can be
+            bool changed = false;
+            for (int other = 0; other < BOARD_SIZE; ++other) {
+                if (other != start && other != next && sees(other, start) && sees(other, next)) {
+                    changed = eliminate(other, digitBit(digit)) || changed;
+                }
+            }
+            if (changed) {
+                return true;
+            }
+        }
+
+        if (depth > 1) {
+            visited[next] = true;
+            if (followChain(start, digit, next, forced, visited, depth - 1)) {
+                return true;
+            }
+            visited[next] = false;
+        }
+    }
+    return false;
+}
+
+bool Grader::guess() {
+    if (solution.empty()) {
+        Solver solver(std::vector<int>(cells.begin(), cells.end()));
+        if (solver.countSolutions(1) == 0) {
+            return false;
+        }
+        solution = solver.getSolution();
+    }
+
+    int best = -1;
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        if (!cells[pos] && (best < 0 || popcount(candidates[pos]) < popcount(candidates[best]))) {
+            best = pos;
+        }
+    }
+
+    place(best, solution[static_cast<size_t>(best)]);
+    return true;
+}
+
+bool Grader::sees(int a, int b) const {
+    const BoardUnits &t = boardUnits();
+    return a != b && (t.row[a] == t.row[b] || t.col[a] == t.col[b] || t.box[a] == t.box[b]);
+}
+}
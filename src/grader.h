@@ -0,0 +1,140 @@
+/*
+ * grader.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_GRADER_H
+#define SUDOQU_GRADER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @brief the solving techniques known to the grader, from the easiest to the hardest
+ */
+enum Technique {
+    NO_TECHNIQUE,
+    HIDDEN_SINGLE,
+    NAKED_SINGLE,
+    LOCKED_CANDIDATES,
+    NAKED_PAIR,
+    X_WING,
+    HIDDEN_PAIR,
+    XY_CHAIN,
+
+    /**
+     * @brief none of the techniques above made progress, a square had to be filled from the solution
+     */
+    GUESSING,
+};
+
+/**
+ * @return a short name for the technique, for logs and tools
+ */
+const char *techniqueName(Technique);
+
+/**
+ * @struct Grade
+ * @brief How hard a puzzle is for a human
+ */
+struct Grade {
+    /**
+     * @brief the sum of the cost of every step taken to solve the puzzle
+     */
+    int rating = 0;
+
+    Technique hardest = NO_TECHNIQUE;
+
+    /**
+     * @brief the number of steps (squares placed or candidates eliminated by one technique)
+     */
+    int steps = 0;
+};
+
+/**
+ * @class Grader
+ * @brief Solves a puzzle the way a person would, to rate how hard it is
+ *
+ * At each step, the easiest technique that makes progress is applied, then the grader starts
+ * again from the easiest one. Candidates are kept as one 9 bit mask per square, so most
+ * techniques are a few masks combined per unit.
+ */
+class Grader {
+public:
+    /**
+     * @param puzzle the 81 squares of the puzzle, 0 for an empty square
+     */
+    explicit Grader(const std::vector<int> &);
+
+    /**
+     * @brief solves the puzzle and rates it
+     * @return the grade, GUESSING as the hardest technique if the puzzle cannot be solved by logic alone
+     */
+    Grade grade();
+
+    /**
+     * @return the cost of one step using the technique
+     */
+    static int cost(Technique);
+
+private:
+    std::array<std::uint8_t, 81> cells{};
+    std::array<std::uint16_t, 81> candidates{};
+    int empty = 0;
+
+    /**
+     * @brief the solution, computed the first time the grader is stuck
+     */
+    std::vector<int> solution;
+
+    void place(int, int);
+
+    /**
+     * @brief removes a digit from the candidates of a square
+     * @return true if it was a candidate
+     */
+    bool eliminate(int, std::uint16_t);
+
+    int hiddenSingles();
+    int nakedSingles();
+    bool lockedCandidates();
+    bool nakedPairs();
+    bool xWing();
+    bool hiddenPairs();
+    bool xyChain();
+    bool guess();
+
+    /**
+     * @brief follows chains of squares with two candidates, from the start square
+     * @param start the square starting the chain
+     * @param digit the digit the start square does not take
+     * @param pos the current end of the chain
+     * @param on the digit the current square is forced to take
+     * @param visited the squares already in the chain
+     * @param depth the number of squares left to add to the chain
+     * @return true if candidates were eliminated
+     */
+    bool followChain(int, int, int, int, std::array<bool, 81> &, int);
+
+    bool sees(int, int) const;
+};
+}
+
+#endif
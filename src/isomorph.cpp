@@ -0,0 +1,277 @@
+/*
+ * isomorph.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "isomorph.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace Sudoqu {
+
+namespace {
+const int BOARD_SIZE = 81;
+
+/**
+ * @brief takes a random permutation of values from the low digits of random (base n)
+ */
+template <size_t n> void shuffle(std::array<int, n> &values, std::uint64_t &random) {
+    for (size_t i = n - 1; i > 0; --i) {
+        std::swap(values[i], values[random % (i + 1)]);
+        random /= i + 1;
+    }
+}
+
+/**
+ * @return the original row (or column) moved to each row (or column)
+ */
+std::array<int, 9> lines(std::uint64_t &random) {
+    std::array<int, 3> bands = {{0, 1, 2}};
+    shuffle(bands, random);
+
+    std::array<int, 9> result;
+    for (size_t band = 0; band < 3; ++band) {
+        std::array<int, 3> within = {{0, 1, 2}};
+        shuffle(within, random);
+        for (size_t i = 0; i < 3; ++i) {
+            result[band * 3 + i] = bands[band] * 3 + within[i];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief the 1296 orders of the columns (or rows) that keep the stacks (or bands) together
+ */
+const std::vector<std::array<std::uint8_t, 9>> &lineOrders() {
+    static const std::vector<std::array<std::uint8_t, 9>> orders = []() {
+        std::vector<std::array<std::uint8_t, 9>> result;
+        std::array<int, 3> perm = {{0, 1, 2}};
+        std::vector<std::array<int, 3>> perms;
+        do {
+            perms.push_back(perm);
+        } while (std::next_permutation(perm.begin(), perm.end()));
+
+        for (auto &stacks : perms) {
+            for (auto &first : perms) {
+                for (auto &second : perms) {
+                    for (auto &third : perms) {
+                        const std::array<int, 3> *within[3] = {&first, &second, &third};
+                        std::array<std::uint8_t, 9> order;
+                        for (size_t i = 0; i < 9; ++i) {
+                            order[i] = static_cast<std::uint8_t>(stacks[i / 3] * 3 + (*within[i / 3])[i % 3]);
+                        }
+                        result.push_back(order);
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+    return orders;
+}
+
+/**
+ * @brief searches the smallest equivalent board, one row at a time
+ *
+ * The first row of the canonical form only depends on where its givens are, so only the
+ * transpositions, first rows and column orders giving the smallest pattern of givens are
+ * tried. Rows are then picked in order; a row whose relabelled digits are larger than the
+ * best row found at that position is abandoned with all the boards starting with it.
+ */
+class Canonicalizer {
+public:
+    std::array<std::uint8_t, 81> best{};
+
+    void run(const std::array<std::uint8_t, 81> &squares) {
+        board = squares;
+
+        // the smallest first row has the fewest givens in its first stack, then in its second...
+        unsigned first_pattern = ~0u;
+        unsigned patterns[2][9];
+        for (int t = 0; t < 2; ++t) {
+            for (size_t r = 0; r < 9; ++r) {
+                std::array<int, 3> counts{};
+                for (size_t c = 0; c < 9; ++c) {
+                    counts[c / 3] += at(t, r, c) ? 1 : 0;
+                }
+                std::sort(counts.begin(), counts.end());
+
+                unsigned pattern = 0;
+                for (int count : counts) {
+                    pattern = (pattern << 3) | ((1u << count) - 1);
+                }
+                patterns[t][r] = pattern;
+                first_pattern = std::min(first_pattern, pattern);
+            }
+        }
+
+        valid = 0;
+        for (transpose = 0; transpose < 2; ++transpose) {
+            for (size_t r = 0; r < 9; ++r) {
+                if (patterns[transpose][r] != first_pattern) {
+                    continue;
+                }
+                for (auto &o : lineOrders()) {
+                    unsigned pattern = 0;
+                    for (size_t c = 0; c < 9; ++c) {
+                        pattern = (pattern << 1) | (at(transpose, r, o[c]) ? 1 : 0);
+                    }
+                    if (pattern == first_pattern) {
+                        order = &o;
+                        std::array<std::uint8_t, 10> labels{};
+                        search(0, static_cast<int>(r), 0, -1, labels, 1);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    std::array<std::uint8_t, 81> board;
+    int transpose = 0;
+    const std::array<std::uint8_t, 9> *order = nullptr;
+
+    /**
+     * @brief the number of rows of best that are set
+     */
+    size_t valid = 0;
+
+    std::uint8_t at(int t, size_t row, size_t col) const {
+        return board[t ? col * 9 + row : row * 9 + col];
+    }
+
+    /**
+     * @param k the position of the next row
+     * @param forced the only row allowed at this position, -1 for any
+     * @param used the rows already placed, one bit per row
+     * @param band the band of the rows being placed
+     * @param labels the new label of each digit seen so far
+     * @param next the next label to give
+     */
+    void search(size_t k, int forced, unsigned used, int band, std::array<std::uint8_t, 10> labels,
+                std::uint8_t next) {
+        if (k == 9) {
+            return;
+        }
+
+        for (int row = 0; row < 9; ++row) {
+            if ((forced >= 0 && row != forced) || (used & (1u << row)) ||
+                (k % 3 == 0 ? (used >> (row / 3 * 3)) & 7 : row / 3 != band)) {
+                continue;
+            }
+
+            std::array<std::uint8_t, 10> l = labels;
+            std::uint8_t n = next;
+            std::uint8_t line[9];
+            for (size_t col = 0; col < 9; ++col) {
+                std::uint8_t value = at(transpose, static_cast<size_t>(row), (*order)[col]);
+                if (value && !l[value]) {
+                    l[value] = n++;
+                }
+                line[col] = l[value];
+            }
+
+            if (k < valid) {
+                int cmp = std::memcmp(line, &best[k * 9], 9);
+                if (cmp > 0) {
+                    continue;
+                }
+                if (cmp < 0) {
+                    valid = k;
+                }
+            }
+            if (k >= valid) {
+                std::memcpy(&best[k * 9], line, 9);
+                valid = k + 1;
+            }
+
+            search(k + 1, -1, used | (1u << row), row / 3, l, n);
+        }
+    }
+};
+}
+
+Isomorph::Isomorph() {
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        squares[static_cast<size_t>(pos)] = static_cast<std::uint8_t>(pos);
+    }
+    for (int digit = 0; digit <= 9; ++digit) {
+        digits[static_cast<size_t>(digit)] = static_cast<std::uint8_t>(digit);
+    }
+}
+
+Isomorph::Isomorph(std::uint64_t random) {
+    std::array<int, 9> labels = {{1, 2, 3, 4, 5, 6, 7, 8, 9}};
+    shuffle(labels, random);
+    digits[0] = 0;
+    for (int digit = 1; digit <= 9; ++digit) {
+        digits[static_cast<size_t>(digit)] = static_cast<std::uint8_t>(labels[static_cast<size_t>(digit - 1)]);
+    }
+
+    std::array<int, 9> rows = lines(random);
+    std::array<int, 9> cols = lines(random);
+    bool transpose = random % 2;
+
+    for (int row = 0; row < 9; ++row) {
+        for (int col = 0; col < 9; ++col) {
+            int r = rows[static_cast<size_t>(row)], c = cols[static_cast<size_t>(col)];
+            squares[static_cast<size_t>(row * 9 + col)] = static_cast<std::uint8_t>(transpose ? c * 9 + r : r * 9 + c);
+        }
+    }
+}
+
+std::vector<int> Isomorph::apply(const std::vector<int> &board) const {
+    std::vector<int> result(BOARD_SIZE, 0);
+    if (board.size() != static_cast<size_t>(BOARD_SIZE)) {
+        return result;
+    }
+
+    for (size_t pos = 0; pos < static_cast<size_t>(BOARD_SIZE); ++pos) {
+        int value = board[squares[pos]];
+        result[pos] = value >= 0 && value <= 9 ? digits[static_cast<size_t>(value)] : 0;
+    }
+    return result;
+}
+
+std::vector<int> Isomorph::canonical(const std::vector<int> &board) {
+    std::array<std::uint8_t, 81> squares{};
+    for (size_t pos = 0; pos < squares.size() && pos < board.size(); ++pos) {
+        int value = board[pos];
+        squares[pos] = static_cast<std::uint8_t>(value >= 0 && value <= 9 ? value : 0);
+    }
+
+    // every order would tie, and there are millions of them
+    if (std::all_of(squares.begin(), squares.end(), [](std::uint8_t value) { return value == 0; })) {
+        return std::vector<int>(squares.size(), 0);
+    }
+
+    Canonicalizer canonicalizer;
+    canonicalizer.run(squares);
+    return std::vector<int>(canonicalizer.best.begin(), canonicalizer.best.end());
+}
+
+std::uint64_t Isomorph::hash(const std::vector<int> &board) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (int value : board) {
+        hash ^= static_cast<std::uint8_t>(value);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+}
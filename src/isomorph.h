@@ -0,0 +1,82 @@
+/*
+ * isomorph.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_ISOMORPH_H
+#define SUDOQU_ISOMORPH_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class Isomorph
+ * @brief A transformation of a board that keeps it valid: its puzzles keep one solution and their difficulty
+ *
+ * The digits are relabelled, the rows are shuffled within their band and the bands shuffled,
+ * the columns within their stack and the stacks shuffled, and the board may be transposed.
+ * That makes about 1.2e12 transformations, so a 64 bit number is enough to pick one.
+ */
+class Isomorph {
+public:
+    /**
+     * @brief the identity, which leaves boards unchanged
+     */
+    Isomorph();
+
+    /**
+     * @brief picks a transformation
+     * @param random any value, most values give a different transformation
+     */
+    explicit Isomorph(std::uint64_t);
+
+    /**
+     * @brief transforms a board, either a puzzle or its solution
+     * @param board the 81 squares of the board, 0 for an empty square
+     * @return the transformed board
+     */
+    std::vector<int> apply(const std::vector<int> &) const;
+
+    /**
+     * @brief the smallest board equivalent to a board, reading its squares in order with 0 before the digits
+     * two boards are equivalent if and only if they have the same canonical form
+     * @param board the 81 squares of the board, 0 for an empty square
+     * @return the canonical form, whose digits are numbered in order of first appearance
+     */
+    static std::vector<int> canonical(const std::vector<int> &);
+
+    /**
+     * @return the 64 bit FNV-1a hash of a board
+     */
+    static std::uint64_t hash(const std::vector<int> &);
+
+private:
+    /**
+     * @brief the square of the original board moved to each square
+     */
+    std::array<std::uint8_t, 81> squares;
+
+    /**
+     * @brief the new label of each digit, 0 stays 0
+     */
+    std::array<std::uint8_t, 10> digits;
+};
+}
+
+#endif
@@ -0,0 +1,431 @@
+/*
+ * journal.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "journal.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Sudoqu {
+
+namespace {
+const quint32 SNAPSHOT_MAGIC = 0x53515350; // "SQSP"
+const quint32 SNAPSHOT_VERSION = 1;
+
+/**
+ * @brief number of events after which the journal should be compacted
+ */
+const quint64 SNAPSHOT_INTERVAL = 1000;
+
+/**
+ * @brief size of a record header: payload length and checksum
+ */
+const int RECORD_HEADER = 6;
+
+const QString SNAPSHOT_FILE = "snapshot.bin";
+const QString JOURNAL_FILE = "journal.bin";
+
+/**
+ * @brief makes what was written to a file survive a power loss, flush() only hands it to the kernel
+ */
+bool syncToDisk(QFileDevice &file) {
+    if (!file.flush()) {
+        return false;
+    }
+#if defined(Q_OS_LINUX)
+    return ::fdatasync(file.handle()) == 0;
+#elif defined(Q_OS_UNIX)
+    return ::fsync(file.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+QDataStream &operator<<(QDataStream &out, const GameState::PlayerState &player) {
+    return out << static_cast<qint32>(player.id) << player.name << player.team;
+}
+
+QDataStream &operator>>(QDataStream &in, GameState::PlayerState &player) {
+    qint32 id;
+    in >> id >> player.name >> player.team;
+    player.id = id;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const std::vector<int> &list) {
+    out << static_cast<quint32>(list.size());
+    for (int i : list) {
+        out << static_cast<qint32>(i);
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, std::vector<int> &list) {
+    quint32 size;
+    in >> size;
+    list.clear();
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        qint32 value;
+        in >> value;
+        list.push_back(value);
+    }
+    return in;
+}
+
+template <typename K, typename V> QDataStream &operator<<(QDataStream &out, const std::map<K, V> &map) {
+    out << static_cast<quint32>(map.size());
+    for (auto &entry : map) {
+        out << entry.first << entry.second;
+    }
+    return out;
+}
+
+template <typename K, typename V> QDataStream &operator>>(QDataStream &in, std::map<K, V> &map) {
+    quint32 size;
+    in >> size;
+    map.clear();
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        K key;
+        V value;
+        in >> key >> value;
+        map[key] = std::move(value);
+    }
+    return in;
+}
+}
+
+Journal::Journal(const QString &dir) : directory(dir) {
+    QDir().mkpath(directory);
+    writer = std::thread(&Journal::run, this);
+}
+
+Journal::~Journal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+bool Journal::restore(GameState &state) {
+    bool restored = false;
+
+    QFile snapshot(directory + "/" + SNAPSHOT_FILE);
+    if (snapshot.open(QIODevice::ReadOnly)) {
+        QByteArray data = snapshot.readAll();
+        QDataStream in(data);
+        in.setVersion(QDataStream::Qt_5_0);
+
+        quint32 magic, version;
+        quint16 checksum;
+        in >> magic >> version >> checksum;
+
+        const int header = static_cast<int>(sizeof(magic) + sizeof(version) + sizeof(checksum));
+        if (magic == SNAPSHOT_MAGIC && version == SNAPSHOT_VERSION && data.size() >= header &&
+            qChecksum(data.constData() + header, static_cast<uint>(data.size() - header)) == checksum) {
+            qint32 mode, current_id;
+            in >> state.sequence >> mode >> state.active >> current_id;
+            in >> state.puzzle >> state.solution >> state.boards >> state.notes >> state.players;
+            state.mode = static_cast<GameMode>(mode);
+            state.current_id = current_id;
+            restored = in.status() == QDataStream::Ok;
+        } else {
+            qWarning() << "Ignoring corrupted snapshot" << snapshot.fileName();
+        }
+    }
+
+    if (!restored) {
+        state = GameState();
+    }
+
+    QFile log(directory + "/" + JOURNAL_FILE);
+    if (log.open(QIODevice::ReadWrite)) {
+        QByteArray data = log.readAll();
+        int offset = 0;
+        while (offset + RECORD_HEADER <= data.size()) {
+            const uchar *header = reinterpret_cast<const uchar *>(data.constData() + offset);
+            int size = static_cast<int>(qFromLittleEndian<quint32>(header));
+            quint16 checksum = qFromLittleEndian<quint16>(header + 4);
+
+            if (size < 0 || offset + RECORD_HEADER + size > data.size()) {
+                break;
+            }
+
+            const char *payload = data.constData() + offset + RECORD_HEADER;
+            Event event;
+            if (qChecksum(payload, static_cast<uint>(size)) != checksum ||
+                !decode(QByteArray::fromRawData(payload, size), event)) {
+                break;
+            }
+
+            // events older than the snapshot were already compacted into it
+            if (event.sequence > state.sequence) {
+                apply(state, event);
+                state.sequence = event.sequence;
+                restored = true;
+            }
+            offset += RECORD_HEADER + size;
+        }
+
+        // drop a record torn by a crash, so new records are appended after valid ones
+        if (offset < data.size()) {
+            qWarning() << "Truncating journal after" << offset << "bytes";
+            log.resize(offset);
+        }
+    }
+
+    sequence = state.sequence;
+    return restored;
+}
+
+void Journal::value(const QString &key, int pos, int value) {
+    Event event;
+    event.type = VALUE;
+    event.key = key;
+    event.pos = pos;
+    event.value = value;
+    record(std::move(event));
+}
+
+void Journal::notes(const QString &team, int pos, const std::vector<int> &notes) {
+    Event event;
+    event.type = NOTES;
+    event.key = team;
+    event.pos = pos;
+    event.notes = notes;
+    record(std::move(event));
+}
+
+void Journal::player(const QString &token, int id, const QString &name, const QString &team) {
+    Event event;
+    event.type = PLAYER;
+    event.key = token;
+    event.player.id = id;
+    event.player.name = name;
+    event.player.team = team;
+    record(std::move(event));
+}
+
+void Journal::playerLeft(const QString &token) {
+    Event event;
+    event.type = PLAYER_LEFT;
+    event.key = token;
+    record(std::move(event));
+}
+
+void Journal::snapshot(GameState state) {
+    state.sequence = sequence;
+    since_snapshot = 0;
+
+    Task task;
+    task.snapshot.reset(new GameState(std::move(state)));
+    push(std::move(task));
+}
+
+bool Journal::snapshotDue() const {
+    return since_snapshot >= SNAPSHOT_INTERVAL;
+}
+
+void Journal::record(Event &&event) {
+    event.sequence = ++sequence;
+    ++since_snapshot;
+
+    Task task;
+    task.event = std::move(event);
+    push(std::move(task));
+}
+
+void Journal::push(Task &&task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void Journal::run() {
+    QFile log(directory + "/" + JOURNAL_FILE);
+    std::deque<Task> batch;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                break;
+            }
+            batch.swap(tasks);
+        }
+
+        // opened lazily: restore() may still be reading it before the first task
+        if (!log.isOpen() && !log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning() << "Could not open journal" << log.fileName();
+        }
+
+        for (Task &task : batch) {
+            if (task.snapshot) {
+                // everything written so far is part of the snapshot, once it is on disk
+                if (writeSnapshot(*task.snapshot)) {
+                    log.resize(0);
+                    syncToDisk(log);
+                }
+            } else {
+                log.write(encode(task.event));
+            }
+        }
+        if (log.isOpen() && !syncToDisk(log)) {
+            qWarning() << "Could not sync journal" << log.fileName();
+        }
+        batch.clear();
+    }
+}
+
+bool Journal::writeSnapshot(const GameState &state) {
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << state.sequence << static_cast<qint32>(state.mode) << state.active << static_cast<qint32>(state.current_id);
+    out << state.puzzle << state.solution << state.boards << state.notes << state.players;
+
+    QSaveFile file(directory + "/" + SNAPSHOT_FILE);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write snapshot" << file.fileName();
+        return false;
+    }
+
+    QDataStream header(&file);
+    header.setVersion(QDataStream::Qt_5_0);
+    header << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << qChecksum(body.constData(), static_cast<uint>(body.size()));
+    file.write(body);
+    if (!syncToDisk(file) || !file.commit()) {
+        qWarning() << "Could not write snapshot" << file.fileName();
+        return false;
+    }
+
+#ifdef Q_OS_UNIX
+    // the rename must be on disk too before the journal is truncated
+    int dir = ::open(QFile::encodeName(directory).constData(), O_RDONLY);
+    if (dir >= 0) {
+        ::fsync(dir);
+        ::close(dir);
+    }
+#endif
+    return true;
+}
+
+void Journal::apply(GameState &state, const Event &event) {
+    switch (event.type) {
+    case VALUE: {
+        auto board = state.boards.find(event.key);
+        if (board == state.boards.end()) {
+            board = state.boards.emplace(event.key, state.puzzle).first;
+        }
+        if (event.pos >= 0 && static_cast<size_t>(event.pos) < board->second.size()) {
+            board->second[static_cast<size_t>(event.pos)] = event.value;
+        }
+        break;
+    }
+    case NOTES:
+        if (event.pos >= 0 && event.pos < 81) {
+            state.notes[event.key][event.pos] = event.notes;
+        }
+        break;
+    case PLAYER:
+        state.players[event.key] = event.player;
+        state.current_id = std::max(state.current_id, event.player.id);
+        break;
+    case PLAYER_LEFT:
+        state.players.erase(event.key);
+        if (state.mode != COOP) {
+            state.boards.erase(event.key);
+        }
+        break;
+    }
+}
+
+QByteArray Journal::encode(const Event &event) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << static_cast<quint8>(event.type) << event.sequence << event.key;
+
+    switch (event.type) {
+    case VALUE:
+        out << static_cast<qint32>(event.pos) << static_cast<qint32>(event.value);
+        break;
+    case NOTES:
+        out << static_cast<qint32>(event.pos) << event.notes;
+        break;
+    case PLAYER:
+        out << event.player;
+        break;
+    case PLAYER_LEFT:
+        break;
+    }
+
+    QByteArray record(RECORD_HEADER, Qt::Uninitialized);
+    uchar *header = reinterpret_cast<uchar *>(record.data());
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header);
+    qToLittleEndian<quint16>(qChecksum(payload.constData(), static_cast<uint>(payload.size())), header + 4);
+    record.append(payload);
+    return record;
+}
+
+bool Journal::decode(const QByteArray &payload, Event &event) {
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint8 type;
+    in >> type >> event.sequence >> event.key;
+    event.type = static_cast<EventType>(type);
+
+    qint32 pos, value;
+    switch (event.type) {
+    case VALUE:
+        in >> pos >> value;
+        event.pos = pos;
+        event.value = value;
+        break;
+    case NOTES:
+        in >> pos >> event.notes;
+        event.pos = pos;
+        break;
+    case PLAYER:
+        in >> event.player;
+        break;
+    case PLAYER_LEFT:
+        break;
+    default:
+        return false;
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+}
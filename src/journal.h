@@ -0,0 +1,199 @@
+/*
+ * journal.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_JOURNAL_H
+#define SUDOQU_JOURNAL_H
+
+#include "constants.h"
+
+#include <QString>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class QFile;
+
+namespace Sudoqu {
+
+/**
+ * @struct GameState
+ * @brief Everything the server needs to bring a game back after a restart
+ */
+struct GameState {
+    struct PlayerState {
+        int id = 0;
+        QString name;
+        QString team;
+    };
+
+    /**
+     * @brief sequence number of the last journal event included in this state
+     */
+    quint64 sequence = 0;
+
+    GameMode mode = NOT_PLAYING;
+    bool active = false;
+    int current_id = 0;
+
+    std::vector<int> puzzle;
+    std::vector<int> solution;
+
+    /**
+     * @brief boards by team name (coop) or by resume token (versus)
+     */
+    std::map<QString, std::vector<int>> boards;
+
+    /**
+     * @brief notes by team name
+     */
+    std::map<QString, std::map<int, std::vector<int>>> notes;
+
+    /**
+     * @brief players who joined the game, by resume token
+     */
+    std::map<QString, PlayerState> players;
+};
+
+/**
+ * @class Journal
+ * @brief Append-only log of the server's state changes, compacted into periodic snapshots
+ *
+ * Events are queued by the event loop and written by a background thread, so recording
+ * one costs a lock and a push. On startup, restore() reads the latest snapshot and replays
+ * the journal written after it.
+ */
+class Journal {
+public:
+    /**
+     * @param directory where the snapshot and the journal are stored
+     */
+    explicit Journal(const QString &);
+    ~Journal();
+
+    /**
+     * @brief reads the last snapshot and the events recorded after it
+     * must be called before recording anything
+     * @param state receives the restored state
+     * @return true if there was something to restore
+     */
+    bool restore(GameState &);
+
+    /**
+     * @brief record a value entered on a board
+     * @param key the team (coop) or the player's resume token (versus)
+     * @param pos the square
+     * @param value the new value
+     */
+    void value(const QString &, int, int);
+
+    /**
+     * @brief record the notes of a team for a square
+     * @param team the team
+     * @param pos the square
+     * @param notes the notes
+     */
+    void notes(const QString &, int, const std::vector<int> &);
+
+    /**
+     * @brief record a player joining or changing name / team
+     * @param token the player's resume token
+     * @param id the player's id
+     * @param name the player's name
+     * @param team the player's team
+     */
+    void player(const QString &, int, const QString &, const QString &);
+
+    /**
+     * @brief record a player leaving for good
+     * @param token the player's resume token
+     */
+    void playerLeft(const QString &);
+
+    /**
+     * @brief replace the journal with a snapshot of the complete state
+     * @param state the current state, its sequence number is set by the journal
+     */
+    void snapshot(GameState);
+
+    /**
+     * @return true when enough events were recorded since the last snapshot
+     */
+    bool snapshotDue() const;
+
+private:
+    enum EventType : quint8 {
+        VALUE = 1,
+        NOTES,
+        PLAYER,
+        PLAYER_LEFT,
+    };
+
+    struct Event {
+        EventType type;
+        quint64 sequence;
+        QString key;
+        int pos = 0;
+        int value = 0;
+        std::vector<int> notes;
+        GameState::PlayerState player;
+    };
+
+    /**
+     * @brief an event to append, or a snapshot to write if snapshot is set
+     */
+    struct Task {
+        Event event;
+        std::unique_ptr<GameState> snapshot;
+    };
+
+    QString directory;
+
+    /**
+     * @brief sequence number of the last event recorded
+     */
+    quint64 sequence = 0;
+
+    quint64 since_snapshot = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Task> tasks;
+    bool stopping = false;
+    std::thread writer;
+
+    void push(Task &&);
+    void record(Event &&);
+    void run();
+
+    /**
+     * @return false if the snapshot could not be written, the journal must then be kept
+     */
+    bool writeSnapshot(const GameState &);
+
+    static void apply(GameState &, const Event &);
+    static QByteArray encode(const Event &);
+    static bool decode(const QByteArray &, Event &);
+};
+}
+
+#endif
@@ -21,7 +21,6 @@
 #include "connectdialog.h"
 #include "colorthemedialog.h"
 #include "game.h"
-#include "player.h"
 
 #include "ui_mainwindow.h"
 
@@ -53,9 +52,25 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     ui->frame->setNotesEnabled(settings.getNotesEnabled());
 
     ui->nickname->setMaxLength(MAX_PLAYERNAME_LENGTH);
+
+    ui->player_list->setModel(&statusModel);
+
+    connect(ui->frame, &GameFrame::boardCompleted, this, [=](bool solved) {
+        ui->status->showMessage(solved ? "Solved!" : "The board is full, but some squares are wrong", 5000);
+    });
+
+    ui->chat_area->setModel(&chatModel);
+    connect(&chatModel, &ChatModel::rowsInserted, ui->chat_area, &QListView::scrollToBottom);
+
+    network.setObjectName("network");
+    network.start();
 }
 
 MainWindow::~MainWindow() {
+    // the player is deleted by the network thread before it stops
+    me.reset();
+    network.quit();
+    network.wait();
     delete ui;
 }
 
@@ -91,8 +106,8 @@ void MainWindow::disconnectPlayer() {
     disconnectAction->setEnabled(false);
     ui->nickname->setEnabled(true);
     ui->start_game->setEnabled(false);
-    ui->chat_area->clear();
-    ui->player_list->clear();
+    chatModel.clear();
+    statusModel.clear();
     ui->frame->stop();
     ui->clear_fields->setEnabled(false);
     ui->select_team->setEnabled(false);
@@ -101,7 +116,7 @@ void MainWindow::disconnectPlayer() {
 
 void MainWindow::closeEvent(QCloseEvent *) {
     if (me) {
-        me->disconnectFromServer();
+        QMetaObject::invokeMethod(me.get(), "disconnectFromServer");
     }
 }
 
@@ -208,6 +223,22 @@ void MainWindow::startServer(bool acceptConnections) {
     ui->puzzle_coop->setEnabled(true);
     ui->puzzle_versus->setEnabled(true);
     game->setTeamNames(settings.getTeamNames());
+    game->setRecordingDirectory(settings.getRecordingDirectory());
+
+    QString puzzleBank = settings.getPuzzleBank();
+    if (!game->setPuzzleBank(puzzleBank)) {
+        ui->status->showMessage(QString("Could not open the puzzle bank %1").arg(puzzleBank));
+    }
+
+    QString journalDirectory = settings.getJournalDirectory();
+    if (!journalDirectory.isEmpty() && game->start_journal(journalDirectory)) {
+        ui->status->showMessage("Restored the previous game");
+    }
+
+    quint16 metricsPort = settings.getMetricsPort();
+    if (metricsPort > 0 && !game->start_metrics(metricsPort)) {
+        ui->status->showMessage(QString("Could not start the metrics endpoint on port %1").arg(metricsPort));
+    }
 }
 
 void MainWindow::stopServer() {
@@ -244,7 +275,8 @@ void MainWindow::connectToServer(QString host) {
 
     me.reset(new Player(nullptr));
     me->setName(ui->nickname->text());
-    me->connectToGame(host);
+    me->moveToThread(&network);
+    playerName = ui->nickname->text();
     connectGameAction->setEnabled(false);
     disconnectAction->setEnabled(true);
     if (game) {
@@ -257,17 +289,27 @@ void MainWindow::connectToServer(QString host) {
 
     connect(me.get(), &Player::playerDisconnected, this, &MainWindow::disconnectPlayer);
 
-    connect(me.get(), &Player::receivedNewPlayer, [this](int id, QString name) {
-        QString message = QString("<strong>%1</strong> has connected.").arg(name);
-        ui->chat_area->appendHtml(message);
+    connect(me.get(), &Player::reconnecting, this, [=](int attempt) {
+        ui->status->showMessage(QString("Connection lost, reconnecting (attempt %1)...").arg(attempt));
+    });
 
-        if (id == me->getId()) {
-            me->setName(name);
-            ui->nickname->setText(name);
-        }
+    connect(me.get(), &Player::sessionResumed, this, [=](QString team) {
+        ui->select_team->blockSignals(true);
+        ui->select_team->setCurrentText(team);
+        ui->select_team->blockSignals(false);
+        ui->status->showMessage("Reconnected", 5000);
+    });
+
+    connect(me.get(), &Player::receivedNewPlayer, this, [this](int, QString name) {
+        chatModel.notice(QString("%1 has connected.").arg(name));
     });
 
-    connect(me.get(), &Player::playerConnected, [=]() {
+    connect(me.get(), &Player::nameChanged, this, [this](QString name) {
+        playerName = name;
+        ui->nickname->setText(name);
+    });
+
+    connect(me.get(), &Player::playerConnected, this, [=]() {
         ui->chat_send_button->setEnabled(true);
         if (game) {
             ui->clear_fields->setEnabled(true);
@@ -276,62 +318,47 @@ void MainWindow::connectToServer(QString host) {
         connect(ui->chat_text, &QLineEdit::returnPressed, this, &MainWindow::sendChatMessage);
     });
 
-    connect(me.get(), &Player::receivedChatMessage, [=](QString name, QString text) {
-        QString msg = QString("<strong>%1</strong>: %2").arg(name).arg(text);
-        ui->chat_area->appendHtml(msg);
-    });
+    connect(me.get(), &Player::receivedChatMessage, this,
+            [=](QString name, QString text) { chatModel.append(name, text); });
 
-    connect(me.get(), &Player::receivedStatusChanges, [=](std::vector<StatusChange> &list, int count_total) {
-        ui->player_list->clear();
-        for (auto p : list) {
-            QColor color(Qt::black);
-
-            if (ui->frame->isGameActive()) {
-                if (p.count == count_total) {
-                    color = p.done ? Qt::green : Qt::red;
-                }
-            }
-
-            QString msg = QString(R"(<strong style="color: %2">%1)").arg(p.name).arg(color.name());
-            if (count_total > 0) {
-                msg += QString(" (%1 / %2)").arg(p.count).arg(count_total);
-            }
-            msg += "</strong><br/>";
-            ui->player_list->appendHtml(msg);
-        }
-    });
+    connect(me.get(), &Player::receivedChatHistory, this,
+            [=](const std::vector<ChatLine> &lines) { chatModel.append(lines); });
+
+    connect(me.get(), &Player::receivedStatusChange, this,
+            [=](const StatusChange &status) { statusModel.apply(status); });
 
-    connect(me.get(), &Player::otherPlayerDisconnected, [=](QString name) {
-        QString message = QString("<strong>%1</strong> has disconnected.").arg(name);
-        ui->chat_area->appendHtml(message);
+    connect(me.get(), &Player::receivedStatusEnd, this,
+            [=](int count_total) { statusModel.finish(count_total, ui->frame->isGameActive()); });
+
+    connect(me.get(), &Player::otherPlayerDisconnected, this, [=](QString name) {
+        chatModel.notice(QString("%1 has disconnected.").arg(name));
     });
 
-    connect(me.get(), &Player::otherPlayerChangedName, [=](QString old_name, QString new_name) {
-        QString msg =
-            QString(R"(<strong>%1</strong> changed name to <strong>%2</strong><br/>)").arg(old_name).arg(new_name);
-        ui->chat_area->appendHtml(msg);
+    connect(me.get(), &Player::otherPlayerChangedName, this, [=](QString old_name, QString new_name) {
+        chatModel.notice(QString("%1 changed name to %2").arg(old_name).arg(new_name));
     });
 
     connect(me.get(), &Player::otherPlayerValues, ui->frame, &GameFrame::otherPlayerValues);
 
-    connect(me.get(), &Player::receivedNewBoard, ui->frame, [=](auto &given, auto &board, GameMode mode) {
-        ui->select_team->blockSignals(true);
-        ui->select_team->setEnabled(mode == COOP);
-        ui->select_team->blockSignals(false);
-        ui->frame->newBoard(given, board, mode);
-    });
+    connect(me.get(), &Player::receivedNewBoard, ui->frame,
+            [=](const Cells &given, const Cells &board, GameMode mode, quint64 hash) {
+                ui->select_team->blockSignals(true);
+                ui->select_team->setEnabled(mode == COOP);
+                ui->select_team->blockSignals(false);
+                ui->frame->newBoard(fromCells(given), fromCells(board), mode, hash);
+            });
 
-    connect(me.get(), &Player::receivedTeamList, [=](QStringList &teams) {
+    connect(me.get(), &Player::receivedTeamList, this, [=](const QStringList &teams) {
         ui->select_team->blockSignals(true);
+        ui->select_team->clear();
         for (auto &t : teams) {
             ui->select_team->addItem(t);
         }
         ui->select_team->blockSignals(false);
     });
 
-    connect(me.get(), &Player::otherPlayerChangedTeam, [=](QString player, QString team) {
-        QString msg = QString(R"(<strong>%1</strong> joined team: <strong>%2</strong><br/>)").arg(player).arg(team);
-        ui->chat_area->appendHtml(msg);
+    connect(me.get(), &Player::otherPlayerChangedTeam, this, [=](QString player, QString team) {
+        chatModel.notice(QString("%1 joined team: %2").arg(player).arg(team));
     });
 
     connect(ui->select_team, &QComboBox::currentTextChanged, me.get(), &Player::changeTeam);
@@ -351,30 +378,32 @@ void MainWindow::connectToServer(QString host) {
     connect(me.get(), &Player::otherPlayerFocus, ui->frame, &GameFrame::otherPlayerFocus);
     connect(me.get(), &Player::badVersion, this, &MainWindow::badVersion);
 
-    connect(me.get(), &Player::gameOverWinner, [=](QString winner) {
+    connect(me.get(), &Player::gameOverWinner, this, [=](QString winner) {
         ui->frame->gameOverWinner();
-        QString msg = QString("<strong>%1</strong> has won the game !<br/>").arg(winner);
-        ui->chat_area->appendHtml(msg);
+        chatModel.notice(QString("%1 has won the game !").arg(winner));
     });
 
     connect(ui->frame, &GameFrame::sendNotes, me.get(), &Player::sendNotes);
     connect(me.get(), &Player::receivedNotes, ui->frame, &GameFrame::receivedNotes);
     connect(me.get(), &Player::clearNotes, ui->frame, &GameFrame::clearNotes);
     connect(ui->frame, &GameFrame::toggleTakingNotes, [=](QString str) { ui->status->showMessage(str); });
+
+    // last, the network thread may emit the first signals before this function returns
+    QMetaObject::invokeMethod(me.get(), "connectToGame", Q_ARG(QString, host));
 }
 
 void MainWindow::changeName() {
     QString name = ui->nickname->text().trimmed();
     if (!name.isEmpty()) {
-        if (me && me->getName() != name) {
-            me->changeName(name);
+        if (me && playerName != name) {
+            QMetaObject::invokeMethod(me.get(), "changeName", Q_ARG(QString, name));
         }
         settings.setName(name);
     }
 }
 
 void MainWindow::sendChatMessage() {
-    QString send = ui->chat_text->text().trimmed().toHtmlEscaped();
+    QString send = ui->chat_text->text().trimmed();
     ui->chat_text->clear();
 
     if (send == "/clear") {
@@ -383,14 +412,13 @@ void MainWindow::sendChatMessage() {
     }
 
     if (me && !send.trimmed().isEmpty()) {
-        me->sendChatMessage(send);
-        QString message = QString("<strong>You: </strong> %1").arg(send);
-        ui->chat_area->appendHtml(message);
+        QMetaObject::invokeMethod(me.get(), "sendChatMessage", Q_ARG(QString, send));
+        chatModel.append("You", send);
     }
 }
 
 void MainWindow::clearChat() {
-    ui->chat_area->clear();
+    chatModel.clear();
 }
 
 void MainWindow::setupServer() {
@@ -413,6 +441,6 @@ void MainWindow::configureColors() {
 
     settings.setColorTheme(theme);
     ui->frame->setColorTheme(theme);
-    ui->frame->repaint();
+    ui->frame->update();
 }
 }
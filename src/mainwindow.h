@@ -19,11 +19,15 @@
 #ifndef SUDOQU_MAINWINDOW_H
 #define SUDOQU_MAINWINDOW_H
 
+#include "chatmodel.h"
 #include "constants.h"
+#include "player.h"
 #include "settings.h"
+#include "statusmodel.h"
 
 #include <QActionGroup>
 #include <QMainWindow>
+#include <QThread>
 
 #include <memory>
 
@@ -34,7 +38,6 @@ class MainWindow;
 namespace Sudoqu {
 
 class Game;
-class Player;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -50,8 +53,20 @@ protected:
 private:
     Ui::MainWindow *ui;
     Settings settings;
+    StatusModel statusModel;
+    ChatModel chatModel;
     std::unique_ptr<Game> game;
-    std::unique_ptr<Player> me;
+    std::unique_ptr<Player, PlayerDeleter> me;
+
+    /**
+     * @brief the client's socket and protocol decoding run in this thread
+     */
+    QThread network;
+
+    /**
+     * @brief our name on the server
+     */
+    QString playerName;
 
     void sendChatMessage();
     void disconnectPlayer();
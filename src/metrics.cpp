@@ -0,0 +1,263 @@
+/*
+ * metrics.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics.h"
+
+#include <QTcpSocket>
+
+#include <algorithm>
+
+namespace Sudoqu {
+
+namespace {
+const auto relaxed = std::memory_order_relaxed;
+
+// microseconds
+const std::initializer_list<quint64> DISPATCH_BOUNDS = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000};
+
+const std::initializer_list<quint64> FANOUT_BOUNDS = {0, 1, 2, 4, 8, 16, 32, 64, 128, 256};
+}
+
+Histogram::Histogram() : count(0), sum(0) {
+    for (auto &bucket : buckets) {
+        bucket.store(0, relaxed);
+    }
+}
+
+Histogram::Histogram(std::initializer_list<quint64> list) : Histogram() {
+    setBounds(list);
+}
+
+void Histogram::setBounds(std::initializer_list<quint64> list) {
+    size = 0;
+    for (quint64 bound : list) {
+        if (size < MAX_BUCKETS) {
+            bounds[size++] = bound;
+        }
+    }
+}
+
+void Histogram::observe(quint64 value) {
+    size_t i = static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.begin() + size, value) - bounds.begin());
+    buckets[i].fetch_add(1, relaxed);
+    count.fetch_add(1, relaxed);
+    sum.fetch_add(value, relaxed);
+}
+
+QString Histogram::expose(const QString &name, const QString &labels) const {
+    QString out;
+    QString prefix = labels.isEmpty() ? "" : labels + ",";
+    QString suffix = labels.isEmpty() ? "" : "{" + labels + "}";
+
+    quint64 cumulative = 0;
+    for (size_t i = 0; i < size; ++i) {
+        cumulative += buckets[i].load(relaxed);
+        out += QString("%1_bucket{%2le=\"%3\"} %4\n").arg(name).arg(prefix).arg(bounds[i]).arg(cumulative);
+    }
+    cumulative += buckets[size].load(relaxed);
+    out += QString("%1_bucket{%2le=\"+Inf\"} %3\n").arg(name).arg(prefix).arg(cumulative);
+    out += QString("%1_sum%2 %3\n").arg(name).arg(suffix).arg(sum.load(relaxed));
+    out += QString("%1_count%2 %3\n").arg(name).arg(suffix).arg(count.load(relaxed));
+    return out;
+}
+
+Metrics::Metrics()
+    : connections_total(0), connections_active(0), bytes_received(0), bytes_sent(0), fanout(FANOUT_BOUNDS) {
+    for (size_t i = 0; i < received.size(); ++i) {
+        received[i].store(0, relaxed);
+        sent[i].store(0, relaxed);
+        dispatch_time[i].setBounds(DISPATCH_BOUNDS);
+    }
+}
+
+size_t Metrics::slot(int type) {
+    if (type < 0 || type >= MESSAGE_TYPES) {
+        return MESSAGE_TYPES;
+    }
+    return static_cast<size_t>(type);
+}
+
+void Metrics::connectionOpened() {
+    connections_total.fetch_add(1, relaxed);
+    connections_active.fetch_add(1, relaxed);
+}
+
+void Metrics::connectionClosed() {
+    connections_active.fetch_sub(1, relaxed);
+}
+
+void Metrics::messageReceived(int type, qint64 bytes, quint64 micros) {
+    size_t i = slot(type);
+    received[i].fetch_add(1, relaxed);
+    bytes_received.fetch_add(static_cast<quint64>(std::max<qint64>(bytes, 0)), relaxed);
+    dispatch_time[i].observe(micros);
+}
+
+void Metrics::messageSent(int type, qint64 bytes) {
+    sent[slot(type)].fetch_add(1, relaxed);
+    bytes_sent.fetch_add(static_cast<quint64>(std::max<qint64>(bytes, 0)), relaxed);
+}
+
+void Metrics::broadcast(size_t players) {
+    fanout.observe(players);
+}
+
+const char *Metrics::messageName(int type) {
+    switch (type) {
+    case BAD_VERSION:
+        return "bad_version";
+    case CHAT_MESSAGE:
+        return "chat_message";
+    case CHANGE_NAME:
+        return "change_name";
+    case CHANGE_TEAM:
+        return "change_team";
+    case DISCONNECT:
+        return "disconnect";
+    case DISCONNECT_OK:
+        return "disconnect_ok";
+    case GAME_OVER_WINNER:
+        return "game_over_winner";
+    case NEW_PLAYER:
+        return "new_player";
+    case NEW_GAME:
+        return "new_game";
+    case NEW_VALUE:
+        return "new_value";
+    case STATUS_CHANGE:
+        return "status_change";
+    case SEND_NAME:
+        return "send_name";
+    case SERVER_DOWN:
+        return "server_down";
+    case SET_FOCUS:
+        return "set_focus";
+    case UPDATE_NOTES:
+        return "update_notes";
+    case YOUR_ID:
+        return "your_id";
+    case PING:
+        return "ping";
+    case PONG:
+        return "pong";
+    case SESSION_RESUMED:
+        return "session_resumed";
+    case CHAT_HISTORY:
+        return "chat_history";
+    }
+    return "unknown";
+}
+
+QString Metrics::expose() const {
+    QString out;
+
+    out += "# HELP sudoqu_connections_total Connections accepted since the server started.\n";
+    out += "# TYPE sudoqu_connections_total counter\n";
+    out += QString("sudoqu_connections_total %1\n").arg(connections_total.load(relaxed));
+
+    out += "# HELP sudoqu_connections_active Players currently connected.\n";
+    out += "# TYPE sudoqu_connections_active gauge\n";
+    out += QString("sudoqu_connections_active %1\n").arg(connections_active.load(relaxed));
+
+    out += "# HELP sudoqu_received_bytes_total Bytes read from players.\n";
+    out += "# TYPE sudoqu_received_bytes_total counter\n";
+    out += QString("sudoqu_received_bytes_total %1\n").arg(bytes_received.load(relaxed));
+
+    out += "# HELP sudoqu_sent_bytes_total Bytes written to players.\n";
+    out += "# TYPE sudoqu_sent_bytes_total counter\n";
+    out += QString("sudoqu_sent_bytes_total %1\n").arg(bytes_sent.load(relaxed));
+
+    out += "# HELP sudoqu_messages_received_total Messages read from players, by type.\n";
+    out += "# TYPE sudoqu_messages_received_total counter\n";
+    for (int i = 0; i <= MESSAGE_TYPES; ++i) {
+        out += QString("sudoqu_messages_received_total{type=\"%1\"} %2\n")
+                   .arg(messageName(i))
+                   .arg(received[static_cast<size_t>(i)].load(relaxed));
+    }
+
+    out += "# HELP sudoqu_messages_sent_total Messages written to players, by type.\n";
+    out += "# TYPE sudoqu_messages_sent_total counter\n";
+    for (int i = 0; i <= MESSAGE_TYPES; ++i) {
+        out += QString("sudoqu_messages_sent_total{type=\"%1\"} %2\n")
+                   .arg(messageName(i))
+                   .arg(sent[static_cast<size_t>(i)].load(relaxed));
+    }
+
+    out += "# HELP sudoqu_dispatch_microseconds Time spent handling a received message, by type.\n";
+    out += "# TYPE sudoqu_dispatch_microseconds histogram\n";
+    for (int i = 0; i <= MESSAGE_TYPES; ++i) {
+        out += dispatch_time[static_cast<size_t>(i)].expose("sudoqu_dispatch_microseconds",
+                                                            QString("type=\"%1\"").arg(messageName(i)));
+    }
+
+    out += "# HELP sudoqu_broadcast_fanout Number of players a single message was sent to.\n";
+    out += "# TYPE sudoqu_broadcast_fanout histogram\n";
+    out += fanout.expose("sudoqu_broadcast_fanout");
+
+    return out;
+}
+
+MetricsServer::MetricsServer(const Metrics &m, QObject *parent) : QTcpServer(parent), metrics(m) {
+    connect(this, &QTcpServer::newConnection, this, &MetricsServer::clientConnected);
+}
+
+bool MetricsServer::start(quint16 port) {
+    return listen(QHostAddress::LocalHost, port);
+}
+
+void MetricsServer::clientConnected() {
+    while (QTcpSocket *socket = nextPendingConnection()) {
+        socket->setParent(this);
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsServer::dataReceived);
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void MetricsServer::dataReceived() {
+    QTcpSocket *socket = static_cast<QTcpSocket *>(this->sender());
+
+    // wait for the complete request head, we ignore any header
+    if (!socket->peek(socket->bytesAvailable()).contains("\r\n\r\n")) {
+        if (socket->bytesAvailable() > 8192) {
+            socket->abort();
+        }
+        return;
+    }
+
+    QList<QByteArray> request = socket->readLine().trimmed().split(' ');
+    socket->readAll();
+
+    if (request.size() < 2 || request[0] != "GET") {
+        reply(socket, "405 Method Not Allowed", "");
+    } else if (request[1] != "/metrics") {
+        reply(socket, "404 Not Found", "");
+    } else {
+        reply(socket, "200 OK", metrics.expose().toUtf8());
+    }
+}
+
+void MetricsServer::reply(QTcpSocket *socket, const QByteArray &status, const QByteArray &body) {
+    QByteArray response = "HTTP/1.0 " + status + "\r\n";
+    response += "Content-Type: text/plain; version=0.0.4\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+}
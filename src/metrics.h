@@ -0,0 +1,170 @@
+/*
+ * metrics.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_METRICS_H
+#define SUDOQU_METRICS_H
+
+#include "constants.h"
+
+#include <QString>
+#include <QTcpServer>
+
+#include <array>
+#include <atomic>
+#include <initializer_list>
+
+class QTcpSocket;
+
+namespace Sudoqu {
+
+/**
+ * @class Histogram
+ * @brief A histogram with fixed upper bounds, safe to update from any thread
+ */
+class Histogram {
+public:
+    static const size_t MAX_BUCKETS = 16;
+
+    Histogram();
+
+    /**
+     * @param bounds the inclusive upper bound of each bucket, in increasing order
+     */
+    Histogram(std::initializer_list<quint64>);
+
+    /**
+     * @brief replaces the bucket bounds, must be called before any observation
+     * @param bounds the inclusive upper bound of each bucket, in increasing order
+     */
+    void setBounds(std::initializer_list<quint64>);
+
+    /**
+     * @brief add one observation to the histogram
+     * @param value the observed value
+     */
+    void observe(quint64);
+
+    /**
+     * @brief writes the histogram in the Prometheus text format
+     * @param name the metric name
+     * @param labels extra labels, without braces (can be empty)
+     */
+    QString expose(const QString &, const QString & = "") const;
+
+private:
+    size_t size = 0;
+    std::array<quint64, MAX_BUCKETS> bounds;
+
+    /**
+     * @brief one counter per bound, plus the +Inf bucket
+     */
+    std::array<std::atomic<quint64>, MAX_BUCKETS + 1> buckets;
+    std::atomic<quint64> count;
+    std::atomic<quint64> sum;
+};
+
+/**
+ * @class Metrics
+ * @brief Counters and histograms describing the server's load
+ *
+ * Every update is a relaxed atomic operation, so it can be called from the hot path.
+ */
+class Metrics {
+public:
+    Metrics();
+
+    void connectionOpened();
+    void connectionClosed();
+
+    /**
+     * @brief count a message read from a player
+     * @param type the Sudoqu::Messages type
+     * @param bytes the size of the message on the wire
+     * @param micros the time spent dispatching the message
+     */
+    void messageReceived(int, qint64, quint64);
+
+    /**
+     * @brief count a message sent to a player
+     * @param type the Sudoqu::Messages type
+     * @param bytes the size of the message on the wire
+     */
+    void messageSent(int, qint64);
+
+    /**
+     * @brief record the number of players a single message was sent to
+     */
+    void broadcast(size_t);
+
+    /**
+     * @return every metric in the Prometheus text exposition format
+     */
+    QString expose() const;
+
+    /**
+     * @return the name used for a Sudoqu::Messages type in the exported labels
+     */
+    static const char *messageName(int);
+
+private:
+    std::atomic<quint64> connections_total;
+    std::atomic<qint64> connections_active;
+    std::atomic<quint64> bytes_received;
+    std::atomic<quint64> bytes_sent;
+
+    /**
+     * @brief one slot per message type, the last one counts unknown types
+     */
+    std::array<std::atomic<quint64>, MESSAGE_TYPES + 1> received;
+    std::array<std::atomic<quint64>, MESSAGE_TYPES + 1> sent;
+
+    std::array<Histogram, MESSAGE_TYPES + 1> dispatch_time;
+    Histogram fanout;
+
+    static size_t slot(int);
+};
+
+/**
+ * @class MetricsServer
+ * @brief Minimal HTTP server answering GET /metrics with the current Sudoqu::Metrics
+ */
+class MetricsServer : public QTcpServer {
+    Q_OBJECT
+
+public:
+    MetricsServer(const Metrics &, QObject * = nullptr);
+
+    /**
+     * @brief starts listening on the loopback interface
+     * @param port the port to listen on
+     * @return true if the server is listening
+     */
+    bool start(quint16);
+
+private:
+    const Metrics &metrics;
+
+    void reply(QTcpSocket *, const QByteArray &, const QByteArray &);
+
+private slots:
+    void clientConnected();
+    void dataReceived();
+};
+}
+
+#endif
@@ -23,11 +23,14 @@
 
 namespace Sudoqu {
 
-void Network::sendNetworkMessage(QJsonObject &obj, QTcpSocket *socket) {
+qint64 Network::sendNetworkMessage(QJsonObject &obj, QTcpSocket *socket) {
     QJsonDocument doc(obj);
-    QString rules(doc.toJson(QJsonDocument::Compact));
-    QTextStream data(socket);
-    data << rules << endl;
+    QByteArray data = doc.toJson(QJsonDocument::Compact);
+    data.append('\n');
+    if (socket->state() != QAbstractSocket::ConnectedState) {
+        return -1;
+    }
+    return socket->write(data);
 }
 
 QJsonObject Network::readNetworkMessage(QString data) {
@@ -36,7 +39,8 @@ QJsonObject Network::readNetworkMessage(QString data) {
 }
 
 StatusChange::StatusChange(const QJsonObject &json)
-    : done(json["done"].toBool()), count(json["count"].toInt()), name(json["name"].toString()) {
+    : done(json["done"].toBool()), count(json["count"].toInt()), name(json["name"].toString()),
+      latency(json["latency"].toInt(-1)) {
 }
 
 QJsonObject StatusChange::toJson() const {
@@ -44,9 +48,23 @@ QJsonObject StatusChange::toJson() const {
     json["done"] = done;
     json["count"] = count;
     json["name"] = name;
+    json["latency"] = latency;
     return json;
 }
 
-StatusChange::StatusChange(bool d, int c, QString n) : done(d), count(c), name(n) {
+StatusChange::StatusChange(bool d, int c, QString n, int l) : done(d), count(c), name(n), latency(l) {
+}
+
+ChatLine::ChatLine(const QJsonObject &json) : name(json["name"].toString()), text(json["text"].toString()) {
+}
+
+QJsonObject ChatLine::toJson() const {
+    QJsonObject json;
+    json["name"] = name;
+    json["text"] = text;
+    return json;
+}
+
+ChatLine::ChatLine(QString n, QString t) : name(n), text(t) {
+}
 }
-}
\ No newline at end of file
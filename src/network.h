@@ -34,13 +34,14 @@ namespace Sudoqu {
 class Network {
 public:
     /**
-     * @fn static void sendNetworkMessage(QJsonObject &, QTcpSocket *)
+     * @fn static qint64 sendNetworkMessage(QJsonObject &, QTcpSocket *)
      * @brief Sends a network message encoded in JSON
      *
      * @param obj The QJsonObject that will be encoded in JSON
      * @param socket The client which will receive this message
+     * @return the number of bytes written, or -1 on error
      */
-    static void sendNetworkMessage(QJsonObject &, QTcpSocket *);
+    static qint64 sendNetworkMessage(QJsonObject &, QTcpSocket *);
 
     /**
      * @fn static QJsonObject readNetworkMessage(QString)
@@ -72,6 +73,11 @@ struct StatusChange {
      */
     QString name;
 
+    /**
+     * @brief latency last round-trip time to the server in milliseconds, -1 if unknown
+     */
+    int latency;
+
     /**
      * @return a json object of the status change
      */
@@ -82,7 +88,28 @@ struct StatusChange {
      */
     StatusChange(const QJsonObject &);
 
-    StatusChange(bool, int, QString);
+    StatusChange(bool = false, int = 0, QString = QString(), int = -1);
+};
+
+/**
+ * @struct ChatLine
+ * @brief A chat message and the name of the player who sent it
+ */
+struct ChatLine {
+    QString name;
+    QString text;
+
+    /**
+     * @return a json object of the chat line
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * @brief construct ChatLine from a QJSonObject
+     */
+    ChatLine(const QJsonObject &);
+
+    ChatLine(QString, QString);
 };
 }
 
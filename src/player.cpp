@@ -24,31 +24,109 @@
 #include <QJsonArray>
 #include <QTcpSocket>
 
+#include <algorithm>
+
 namespace Sudoqu {
 
+namespace {
+/**
+ * @brief delay before the first reconnection, doubled on every attempt
+ */
+const int RECONNECT_DELAY = 1000;
+
+const int MAX_RECONNECT_DELAY = 8000;
+
+/**
+ * @brief enough attempts to cover the server's RESUME_GRACE_PERIOD
+ */
+const int MAX_RECONNECT_ATTEMPTS = 8;
+
+/**
+ * @return the notes listed in a message, as a mask
+ */
+Notes toNotes(const QJsonArray &array) {
+    Notes notes = 0;
+    for (auto note : array) {
+        int n = note.toInt();
+        if (n >= 1 && n <= 9) {
+            notes |= 1 << (n - 1);
+        }
+    }
+    return notes;
+}
+}
+
 void SocketDeleter::operator()(QTcpSocket *s) {
     s->deleteLater();
 }
 
-Player::Player(QTcpSocket *s) {
+void PlayerDeleter::operator()(Player *p) {
+    p->deleteLater();
+}
+
+Player::Player(QTcpSocket *s) : idle_timer(this), reconnect_timer(this), batch_timer(this) {
+    qRegisterMetaType<GameMode>();
+    qRegisterMetaType<Cells>();
+    qRegisterMetaType<CellChanges>();
+    qRegisterMetaType<StatusChange>();
+    qRegisterMetaType<std::vector<ChatLine>>();
+    qRegisterMetaType<Notes>("Notes");
+
+    // our own socket is a child, so it follows us to the network thread
     if (s == nullptr) {
-        s = new QTcpSocket;
+        s = new QTcpSocket(this);
     }
     socket = std::unique_ptr<QTcpSocket, SocketDeleter>(s, SocketDeleter());
+
+    idle_timer.setSingleShot(true);
+    idle_timer.setInterval(IDLE_TIMEOUT);
+    connect(&idle_timer, &QTimer::timeout, this, [=]() { socket->abort(); });
+
+    reconnect_timer.setSingleShot(true);
+    connect(&reconnect_timer, &QTimer::timeout, this, [=]() { socket->connectToHost(host, 19770); });
+
+    batch_timer.setSingleShot(true);
+    batch_timer.setInterval(INPUT_BATCH_DELAY);
+    connect(&batch_timer, &QTimer::timeout, this, &Player::flushBatch);
 }
 
 void Player::connectToGame(QString host) {
+    this->host = host;
     socket->connectToHost(host, 19770);
     connect(socket.get(), &QTcpSocket::connected, this, &Player::clientConnected);
     connect(socket.get(), &QTcpSocket::disconnected, this, &Player::clientDisconnected);
     void (QAbstractSocket::*sig)(QAbstractSocket::SocketError) = &QAbstractSocket::error;
-    connect(socket.get(), sig, [=](QAbstractSocket::SocketError) { emit playerDisconnected(); });
+    connect(socket.get(), sig, this, [=](QAbstractSocket::SocketError) { connectionLost(); });
+}
+
+void Player::connectionLost() {
+    idle_timer.stop();
+
+    if (reconnect_timer.isActive()) {
+        return;
+    }
+
+    if (leaving || token.isEmpty() || reconnect_attempts >= MAX_RECONNECT_ATTEMPTS) {
+        emit playerDisconnected();
+        return;
+    }
+
+    // exponential backoff with jitter, so a whole room does not reconnect at the same time
+    int delay = std::min(RECONNECT_DELAY << reconnect_attempts, MAX_RECONNECT_DELAY) +
+                static_cast<int>(random.below(static_cast<std::uint32_t>(RECONNECT_DELAY)));
+    ++reconnect_attempts;
+    reconnect_timer.start(delay);
+    emit reconnecting(reconnect_attempts);
 }
 
 void Player::disconnectFromServer() {
+    flushBatch();
+    leaving = true;
     QJsonObject obj;
     obj["message"] = DISCONNECT;
     sendMessage(obj);
+    // the network thread may stop before the event loop gets to write it
+    socket->flush();
 }
 
 void Player::setName(QString name) {
@@ -75,19 +153,74 @@ Sudoqu::Player::operator QTcpSocket *() {
 }
 
 void Player::sendValue(int pos, int value) {
+    pending_values.set(pos, value);
+    if (mode == COOP) {
+        CellChanges move;
+        move.set(pos, value);
+        batch_seq = sync.localMoves(move);
+    }
+    scheduleBatch();
+}
+
+void Player::sendValues(const Cells &values) {
+    pending_values.clear();
+    flushBatch();
+
     QJsonObject obj;
+    if (mode == COOP) {
+        CellChanges cells;
+        cells.values = values;
+        cells.changed.set();
+        obj["seq"] = static_cast<qint64>(sync.localMoves(cells));
+    }
     obj["message"] = NEW_VALUE;
-    obj["pos"] = pos;
-    obj["val"] = value;
+    QJsonArray array;
+    for (auto value : values) {
+        array.append(value);
+    }
+    obj["values"] = array;
     sendMessage(obj);
 }
 
-void Player::sendValues(std::vector<int> &values) {
+void Player::scheduleBatch() {
+    if (!batch_timer.isActive()) {
+        batch_timer.start();
+    }
+}
+
+void Player::flushBatch() {
+    batch_timer.stop();
+
+    if (!pending_values.empty()) {
+        sendCells(pending_values, batch_seq);
+        pending_values.clear();
+    }
+
+    if (focus_changed) {
+        focus_changed = false;
+
+        QJsonObject obj;
+        obj["message"] = SET_FOCUS;
+        obj["pos"] = pending_focus;
+        obj["id"] = id;
+        sendMessage(obj);
+    }
+}
+
+void Player::sendCells(const CellChanges &values, quint64 seq) {
+    QJsonObject cells;
+    for (int pos = 0; pos < 81; ++pos) {
+        if (values.has(pos)) {
+            cells[QString::number(pos)] = values.at(pos);
+        }
+    }
+
     QJsonObject obj;
     obj["message"] = NEW_VALUE;
-    std::list<QVariant> list(values.begin(), values.end());
-    QJsonArray array = QJsonArray::fromVariantList(QVariantList::fromStdList(list));
-    obj["values"] = array;
+    obj["cells"] = cells;
+    if (mode == COOP) {
+        obj["seq"] = static_cast<qint64>(seq);
+    }
     sendMessage(obj);
 }
 
@@ -100,13 +233,16 @@ void Player::setId(int i) {
 }
 
 void Player::clientConnected() {
-    connect(socket.get(), &QTcpSocket::readyRead, this, &Player::dataReceived);
-    emit playerConnected();
+    connect(socket.get(), &QTcpSocket::readyRead, this, &Player::dataReceived, Qt::UniqueConnection);
+    idle_timer.start();
+    if (reconnect_attempts == 0) {
+        emit playerConnected();
+    }
 }
 
 void Player::clientDisconnected() {
     if (socket->state() == QAbstractSocket::UnconnectedState || socket->waitForDisconnected(1000)) {
-        emit playerDisconnected();
+        connectionLost();
     }
 }
 
@@ -121,7 +257,7 @@ bool Player::isDone() const {
 void Player::changeName(QString new_name) {
     QJsonObject obj;
     obj["message"] = CHANGE_NAME;
-    obj["new_name"] = new_name.toHtmlEscaped();
+    obj["new_name"] = new_name;
     sendMessage(obj);
 }
 
@@ -134,19 +270,24 @@ void Player::changeTeam(QString team) {
 }
 
 void Player::sendFocusedSquare(int pos) {
-    QJsonObject obj;
-    obj["message"] = SET_FOCUS;
-    obj["pos"] = pos;
-    obj["id"] = id;
-    sendMessage(obj);
+    pending_focus = pos;
+    focus_changed = true;
+    scheduleBatch();
 }
 
-void Player::sendNotes(int pos, std::vector<int> &notes) {
+void Player::sendNotes(int pos, Notes notes) {
+    // a value entered in the square just before must reach the server first
+    flushBatch();
+
     QJsonObject obj;
     obj["message"] = UPDATE_NOTES;
     obj["pos"] = pos;
-    std::list<QVariant> list(notes.begin(), notes.end());
-    QJsonArray array = QJsonArray::fromVariantList(QVariantList::fromStdList(list));
+    QJsonArray array;
+    for (int note = 1; note <= 9; ++note) {
+        if (notes & (1 << (note - 1))) {
+            array.append(note);
+        }
+    }
     obj["notes"] = array;
     sendMessage(obj);
 }
@@ -159,7 +300,16 @@ void Player::setTeam(const QString &t) {
     team = t;
 }
 
+QString Player::getToken() const {
+    return token;
+}
+
+void Player::setToken(const QString &t) {
+    token = t;
+}
+
 void Player::dataReceived() {
+    idle_timer.start();
     QString data;
     while (socket != nullptr && socket->canReadLine()) {
         data = socket->readLine();
@@ -173,10 +323,16 @@ void Player::dataReceived() {
                 QJsonObject send;
                 send["message"] = SEND_NAME;
                 send["id"] = id;
-                send["name"] = name.toHtmlEscaped();
+                send["name"] = name;
                 send["version"] = SUDOQU_VERSION;
+                if (!token.isEmpty()) {
+                    send["resume"] = token;
+                }
                 sendMessage(send);
 
+                token = obj["token"].toString();
+                reconnect_attempts = 0;
+
                 auto arr_teams = obj["teams"].toArray();
                 QStringList teams;
                 for (auto t : arr_teams) {
@@ -191,6 +347,10 @@ void Player::dataReceived() {
             }
 
             case NEW_PLAYER:
+                if (obj["id"].toInt() == id) {
+                    name = obj["name"].toString();
+                    emit nameChanged(name);
+                }
                 emit receivedNewPlayer(obj["id"].toInt(), obj["name"].toString());
                 break;
 
@@ -198,23 +358,22 @@ void Player::dataReceived() {
                 emit receivedChatMessage(obj["name"].toString(), obj["text"].toString());
                 break;
 
-            case STATUS_CHANGE: {
-                std::vector<StatusChange> list;
+            case CHAT_HISTORY: {
+                // one signal, so the chat inserts the whole history at once
+                std::vector<ChatLine> lines;
+                for (auto line : obj["lines"].toArray()) {
+                    lines.emplace_back(line.toObject());
+                }
+                emit receivedChatHistory(lines);
+                break;
+            }
 
+            case STATUS_CHANGE:
                 for (auto change : obj["changes"].toArray()) {
-                    list.emplace_back(change.toObject());
+                    emit receivedStatusChange(StatusChange(change.toObject()));
                 }
-
-                std::sort(list.begin(), list.end(), [](auto &a, auto &b) {
-                    if (a.count == b.count) {
-                        return a.name > b.name;
-                    }
-                    return a.count > b.count;
-                });
-
-                emit receivedStatusChanges(list, obj["count_total"].toInt());
+                emit receivedStatusEnd(obj["count_total"].toInt());
                 break;
-            }
 
             case DISCONNECT:
                 emit otherPlayerDisconnected(obj["name"].toString());
@@ -222,38 +381,58 @@ void Player::dataReceived() {
 
             case DISCONNECT_OK:
             case SERVER_DOWN:
+                leaving = true;
                 socket->disconnectFromHost();
                 break;
 
+            case SESSION_RESUMED:
+                id = obj["id"].toInt();
+                name = obj["name"].toString();
+                team = obj["team"].toString();
+                token = obj["token"].toString();
+                emit nameChanged(name);
+                emit sessionResumed(team);
+
+                // moves up to last_seq reached the server even if their echo was lost, only the
+                // ones after it are sent again
+                batch_timer.stop();
+                pending_values.clear();
+                if (mode == COOP) {
+                    sync.acknowledge(static_cast<quint64>(obj["last_seq"].toDouble()));
+                    for (auto &moves : sync.getPending()) {
+                        sendCells(moves.cells, moves.seq);
+                    }
+                }
+                break;
+
             case NEW_GAME: {
                 auto array = obj["given"].toArray();
-                std::vector<int> given;
-                for (int i = 0; i < array.size(); ++i) {
-                    given.push_back(array[i].toInt());
+                Cells given{};
+                for (int i = 0; i < array.size() && i < 81; ++i) {
+                    given[static_cast<size_t>(i)] = static_cast<quint8>(array[i].toInt());
                 }
 
-                auto board = given;
+                Cells board = given;
                 if (obj.find("board") != obj.end()) {
-                    board.clear();
+                    board.fill(0);
                     array = obj["board"].toArray();
-                    for (int i = 0; i < array.size(); ++i) {
-                        board.push_back(array[i].toInt());
+                    for (int i = 0; i < array.size() && i < 81; ++i) {
+                        board[static_cast<size_t>(i)] = static_cast<quint8>(array[i].toInt());
                     }
                 }
-                GameMode mode = static_cast<GameMode>(obj["mode"].toInt());
+                mode = static_cast<GameMode>(obj["mode"].toInt());
+                if (mode == COOP) {
+                    sync.reset(board, static_cast<quint64>(obj["rev"].toDouble()));
+                }
 
-                emit receivedNewBoard(given, board, mode);
+                quint64 solution_hash = obj["solution_hash"].toString().toULongLong(nullptr, 16);
+                emit receivedNewBoard(given, board, mode, solution_hash);
 
                 if (mode == COOP) {
                     emit clearNotes();
                     QJsonObject notes_obj = obj["notes"].toObject();
                     for (auto it = notes_obj.begin(); it != notes_obj.end(); ++it) {
-                        std::vector<int> notes;
-                        int pos = it.key().toInt();
-                        for (auto note : it.value().toArray()) {
-                            notes.push_back(note.toInt());
-                        }
-                        emit receivedNotes(pos, notes);
+                        emit receivedNotes(it.key().toInt(), toNotes(it.value().toArray()));
                     }
                 }
 
@@ -263,19 +442,36 @@ void Player::dataReceived() {
             case CHANGE_NAME:
                 if (obj["id"].toInt() == id) {
                     name = obj["new_name"].toString();
+                    emit nameChanged(name);
                 }
                 emit otherPlayerChangedName(obj["old_name"].toString(), obj["new_name"].toString());
                 break;
 
             case NEW_VALUE: {
-                std::map<int, int> values;
+                CellChanges values;
 
-                if (obj.find("values") == obj.end()) {
-                    values[obj["pos"].toInt()] = obj["val"].toInt();
+                if (obj.contains("cells")) {
+                    QJsonObject cells = obj["cells"].toObject();
+                    for (auto it = cells.begin(); it != cells.end(); ++it) {
+                        values.set(it.key().toInt(), it.value().toInt());
+                    }
+                } else if (obj.find("values") == obj.end()) {
+                    values.set(obj["pos"].toInt(), obj["val"].toInt());
                 } else {
                     auto tmp_values = obj["values"].toArray();
                     for (int i = 0; i < tmp_values.size(); ++i) {
-                        values[i] = tmp_values[i].toInt();
+                        values.set(i, tmp_values[i].toInt());
+                    }
+                }
+
+                if (mode == COOP && obj.contains("rev")) {
+                    quint64 acknowledged = 0;
+                    if (obj["id"].toInt() == id) {
+                        acknowledged = static_cast<quint64>(obj["seq"].toDouble());
+                    }
+                    values = sync.remoteMoves(static_cast<quint64>(obj["rev"].toDouble()), values, acknowledged);
+                    if (values.empty()) {
+                        break;
                     }
                 }
 
@@ -307,13 +503,15 @@ void Player::dataReceived() {
 
                 break;
             }
-            case UPDATE_NOTES: {
-                int pos = obj["pos"].toInt();
-                std::vector<int> notes;
-                for (auto i : obj["notes"].toArray()) {
-                    notes.push_back(i.toInt());
-                }
-                emit receivedNotes(pos, notes);
+            case UPDATE_NOTES:
+                emit receivedNotes(obj["pos"].toInt(), toNotes(obj["notes"].toArray()));
+                break;
+
+            case PING: {
+                QJsonObject pong;
+                pong["message"] = PONG;
+                pong["ts"] = obj["ts"];
+                sendMessage(pong);
                 break;
             }
             }
@@ -19,11 +19,15 @@
 #ifndef SUDOQU_PLAYER_H
 #define SUDOQU_PLAYER_H
 
+#include "boardsync.h"
+#include "cells.h"
 #include "constants.h"
 #include "network.h"
+#include "random.h"
 
 #include <QObject>
 #include <QString>
+#include <QTimer>
 
 #include <memory>
 #include <vector>
@@ -37,9 +41,21 @@ struct SocketDeleter {
     void operator()(QTcpSocket *);
 };
 
+class Player;
+
+/**
+ * @brief deletes a Player from the thread it lives in
+ */
+struct PlayerDeleter {
+    void operator()(Player *);
+};
+
 /**
  * @class Player
  * @brief The Player / Network client
+ *
+ * On the client, the Player is moved to a network thread: its slots are called through
+ * queued connections and its signals are delivered to the GUI thread as decoded values.
  */
 class Player : public QObject {
     Q_OBJECT
@@ -59,6 +75,15 @@ public:
     QString getTeam() const;
     void setTeam(const QString &value);
 
+    /**
+     * @return the token used to resume this player's session after a dropped connection
+     */
+    QString getToken() const;
+    void setToken(const QString &);
+
+    operator QTcpSocket *();
+
+public slots:
     /**
      * @brief connectToGame connect to the server
      * @param host the host to connect to
@@ -76,20 +101,19 @@ public:
      */
     void sendChatMessage(QString);
 
-    operator QTcpSocket *();
-
     /**
      * @brief send new value for the player's board
+     * values entered within INPUT_BATCH_DELAY are sent together in one message
      * @param pos the square the player changed
      * @param value the value of the square changed
      */
     void sendValue(int, int);
 
     /**
-        * @brief send a complete board to the server
+        * @brief send a complete board to the server, replacing the values waiting to be sent
         * @param board the values
         */
-    void sendValues(std::vector<int> &);
+    void sendValues(const Cells &);
 
     /**
      * @brief changeName change the player's name, and send the new name to the server
@@ -106,6 +130,7 @@ public:
     /**
      * @brief sendFocusedSquare send the currently focused square to the server
      *	useful in co-op mode so teammates can see what you are "working" on
+     *	only the last position focused within INPUT_BATCH_DELAY is sent
      * @param pos the position currently focused
      */
     void sendFocusedSquare(int);
@@ -115,7 +140,7 @@ public:
      * @param pos the position
      * @param notes the notes for that position
      */
-    void sendNotes(int, std::vector<int> &);
+    void sendNotes(int, Notes);
 
 signals:
     /**
@@ -125,6 +150,12 @@ signals:
      */
     void receivedNewPlayer(int, QString);
 
+    /**
+     * @brief emitted when the server gave us a name, which may differ from the one we asked for
+     * @param name our name on the server
+     */
+    void nameChanged(QString);
+
     /**
      * @brief emitted when the player is connected to the server
      */
@@ -135,6 +166,18 @@ signals:
      */
     void playerDisconnected();
 
+    /**
+     * @brief emitted when the connection dropped and a reconnection is scheduled
+     * @param attempt the number of the upcoming attempt, starting at 1
+     */
+    void reconnecting(int);
+
+    /**
+     * @brief emitted when the server gave back our previous id, name, team and board
+     * @param team the player's team
+     */
+    void sessionResumed(QString);
+
     /**
      * @brief emitted after receiving a chat message from the server
      * @param name the player who sent the message
@@ -143,11 +186,24 @@ signals:
     void receivedChatMessage(QString, QString);
 
     /**
-     * @brief emitted after receiving status changes (for the game info panel)
-     * @param list the list of Sudoqu::StatusChange
+     * @brief emitted after joining a game, with the last messages sent before we joined
+     * @param lines the messages, oldest first
+     */
+    void receivedChatHistory(const std::vector<ChatLine> &);
+
+    /**
+     * @brief emitted for each player / team listed in a status update (for the game info panel),
+     * in the order sent by the server
+     * @param status the player / team's status
+     */
+    void receivedStatusChange(const StatusChange &);
+
+    /**
+     * @brief emitted after the last receivedStatusChange of a status update,
+     * the players / teams it did not list are gone
      * @param count_total the number of total squares
      */
-    void receivedStatusChanges(std::vector<StatusChange> &, int);
+    void receivedStatusEnd(int);
 
     /**
      * @brief emitted after a player has disconnected
@@ -159,8 +215,9 @@ signals:
      * @param given the list of given for the current game
      * @param board the current board for the player / team
      * @param mode the game mode (versus / coop)
+     * @param solution_hash the hash of the solution (Isomorph::hash), to check the board without solving it
      */
-    void receivedNewBoard(std::vector<int> &, std::vector<int> &, GameMode);
+    void receivedNewBoard(const Cells &, const Cells &, GameMode, quint64);
 
     /**
      * @brief emitted after another player changed their name on the server
@@ -172,9 +229,9 @@ signals:
 
     /**
      * @brief emitted after receiving a new value from a new player (coop mode)
-     * @param list of updated values
+     * @param changes the updated values
      */
-    void otherPlayerValues(std::map<int, int> &);
+    void otherPlayerValues(const CellChanges &);
 
     /**
      * @brief emitted after receiving a new focus position for a player (coop mode)
@@ -194,7 +251,7 @@ signals:
      * @brief emitted after receiving the team list from the server
      * @param teams the list of teams
      */
-    void receivedTeamList(QStringList &);
+    void receivedTeamList(const QStringList &);
 
     /**
      * @brief emitted after another player changed their team
@@ -214,7 +271,7 @@ signals:
      * @param pos the position
      * @param the notes for that position
      */
-    void receivedNotes(int, std::vector<int> &);
+    void receivedNotes(int, Notes);
 
     /**
      * @brief clear the player's notes
@@ -244,6 +301,95 @@ private:
      */
     QString team;
 
+    /**
+     * @brief client side: fires when the server has been silent for too long
+     */
+    QTimer idle_timer;
+
+    /**
+     * @brief token sent back to the server to resume our session after a dropped connection
+     */
+    QString token;
+
+    /**
+     * @brief client side: the host we are connected to
+     */
+    QString host;
+
+    /**
+     * @brief client side: true once we asked to leave, so a lost connection is not resumed
+     */
+    bool leaving = false;
+
+    /**
+     * @brief client side: number of reconnections attempted since the connection dropped
+     */
+    int reconnect_attempts = 0;
+
+    /**
+     * @brief client side: fires when it is time to attempt a reconnection
+     */
+    QTimer reconnect_timer;
+
+    /**
+     * @brief client side: draws the reconnection jitter, seeded differently in every client
+     */
+    Random random;
+
+    /**
+     * @brief client side: the mode of the current game
+     */
+    GameMode mode = NOT_PLAYING;
+
+    /**
+     * @brief client side: our team's board in coop, with the moves the server has not ordered yet
+     */
+    BoardSync sync;
+
+    /**
+     * @brief client side: values entered and not sent yet
+     */
+    CellChanges pending_values;
+
+    /**
+     * @brief client side: sequence number of the last value in pending_values (coop)
+     */
+    quint64 batch_seq = 0;
+
+    /**
+     * @brief client side: the focus to send, if it changed since the last batch
+     */
+    int pending_focus = -1;
+    bool focus_changed = false;
+
+    /**
+     * @brief client side: fires at the end of the batching window
+     */
+    QTimer batch_timer;
+
+    /**
+     * @brief starts the batching window, if it is not already running
+     */
+    void scheduleBatch();
+
+    /**
+     * @brief sends the values and the focus collected since the last batch
+     */
+    void flushBatch();
+
+    /**
+     * @brief sends values for the player's board
+     * @param cells the values
+     * @param seq their sequence number, sent in coop only
+     */
+    void sendCells(const CellChanges &, quint64);
+
+    /**
+     * @brief called when the connection was lost or could not be established,
+     * schedules a reconnection if the session can still be resumed
+     */
+    void connectionLost();
+
     /**
      * @brief sends a JSON encoded message to the server
      * wrapper around Sudoqu::Network::sendNetworkMessage
@@ -268,4 +414,10 @@ private slots:
 };
 };
 
+Q_DECLARE_METATYPE(Sudoqu::GameMode)
+Q_DECLARE_METATYPE(Sudoqu::Cells)
+Q_DECLARE_METATYPE(Sudoqu::CellChanges)
+Q_DECLARE_METATYPE(Sudoqu::StatusChange)
+Q_DECLARE_METATYPE(std::vector<Sudoqu::ChatLine>)
+
 #endif
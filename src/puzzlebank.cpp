@@ -0,0 +1,189 @@
+/*
+ * puzzlebank.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "puzzlebank.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+
+namespace Sudoqu {
+
+namespace {
+const char MAGIC[4] = {'S', 'Q', 'P', 'B'};
+const quint8 BANK_VERSION = 1;
+
+const int DIFFICULTIES = SB::EXPERT + 1;
+const int HEADER_SIZE = 8 + DIFFICULTIES * 8;
+
+const int BOARD_SIZE = 81;
+const int SOLUTION_SIZE = (BOARD_SIZE + 1) / 2;
+const int GIVENS_SIZE = (BOARD_SIZE + 7) / 8;
+const int RECORD_SIZE = SOLUTION_SIZE + GIVENS_SIZE + 4;
+
+QByteArray pack(const PuzzleBank::Entry &entry) {
+    QByteArray record(RECORD_SIZE, '\0');
+    uchar *out = reinterpret_cast<uchar *>(record.data());
+
+    for (int pos = 0; pos < BOARD_SIZE && static_cast<size_t>(pos) < entry.solution.size(); ++pos) {
+        int value = entry.solution[static_cast<size_t>(pos)] & 0x0f;
+        out[pos / 2] |= static_cast<uchar>(pos % 2 ? value << 4 : value);
+    }
+
+    uchar *givens = out + SOLUTION_SIZE;
+    for (int pos = 0; pos < BOARD_SIZE && static_cast<size_t>(pos) < entry.puzzle.size(); ++pos) {
+        if (entry.puzzle[static_cast<size_t>(pos)] > 0) {
+            givens[pos / 8] |= static_cast<uchar>(1u << (pos % 8));
+        }
+    }
+
+    uchar *tail = givens + GIVENS_SIZE;
+    qToLittleEndian<quint16>(static_cast<quint16>(std::min(std::max(entry.rating, 0), 0xffff)), tail);
+    tail[2] = static_cast<uchar>(entry.hardest);
+    return record;
+}
+}
+
+bool PuzzleBank::open(const QString &path) {
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE) {
+        close();
+        return false;
+    }
+
+    data = file.map(0, file.size());
+    if (data == nullptr || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), reinterpret_cast<const char *>(data)) ||
+        data[4] != BANK_VERSION) {
+        close();
+        return false;
+    }
+
+    quint64 records = static_cast<quint64>(file.size() - HEADER_SIZE) / RECORD_SIZE;
+    for (int d = 0; d < DIFFICULTIES; ++d) {
+        first[d] = qFromLittleEndian<quint32>(data + 8 + d * 8);
+        counts[d] = qFromLittleEndian<quint32>(data + 12 + d * 8);
+        if (static_cast<quint64>(first[d]) + counts[d] > records) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void PuzzleBank::close() {
+    if (data != nullptr) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    file.close();
+    first.fill(0);
+    counts.fill(0);
+}
+
+bool PuzzleBank::isOpen() const {
+    return data != nullptr;
+}
+
+int PuzzleBank::count(SB::Difficulty difficulty) const {
+    if (difficulty < 0 || difficulty >= DIFFICULTIES) {
+        return 0;
+    }
+    return static_cast<int>(counts[difficulty]);
+}
+
+PuzzleBank::Entry PuzzleBank::at(SB::Difficulty difficulty, int index) const {
+    Entry entry;
+    entry.difficulty = difficulty;
+
+    if (index < 0 || index >= count(difficulty)) {
+        return entry;
+    }
+
+    const uchar *record = data + HEADER_SIZE + (static_cast<qint64>(first[difficulty]) + index) * RECORD_SIZE;
+    const uchar *givens = record + SOLUTION_SIZE;
+
+    entry.solution.resize(BOARD_SIZE);
+    entry.puzzle.resize(BOARD_SIZE);
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        int value = pos % 2 ? record[pos / 2] >> 4 : record[pos / 2] & 0x0f;
+        if (value < 1 || value > 9) {
+            entry.solution.clear();
+            entry.puzzle.clear();
+            return entry;
+        }
+        entry.solution[static_cast<size_t>(pos)] = value;
+        entry.puzzle[static_cast<size_t>(pos)] = givens[pos / 8] & (1u << (pos % 8)) ? value : 0;
+    }
+
+    const uchar *tail = givens + GIVENS_SIZE;
+    entry.rating = qFromLittleEndian<quint16>(tail);
+    entry.hardest = static_cast<Technique>(tail[2]);
+    return entry;
+}
+
+bool PuzzleBank::sample(SB::Difficulty difficulty, Random &random, Entry &entry) const {
+    int size = count(difficulty);
+    if (size == 0) {
+        return false;
+    }
+    entry = at(difficulty, static_cast<int>(random.below(static_cast<std::uint32_t>(size))));
+    return !entry.solution.empty();
+}
+
+void PuzzleBankWriter::add(const PuzzleBank::Entry &entry) {
+    int difficulty = std::min(std::max(static_cast<int>(entry.difficulty), 0), DIFFICULTIES - 1);
+    records[difficulty].append(pack(entry));
+}
+
+int PuzzleBankWriter::size() const {
+    int size = 0;
+    for (auto &bucket : records) {
+        size += bucket.size() / RECORD_SIZE;
+    }
+    return size;
+}
+
+bool PuzzleBankWriter::save(const QString &path) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QByteArray header(HEADER_SIZE, '\0');
+    uchar *out = reinterpret_cast<uchar *>(header.data());
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.data());
+    out[4] = BANK_VERSION;
+
+    quint32 index = 0;
+    for (int d = 0; d < DIFFICULTIES; ++d) {
+        quint32 size = static_cast<quint32>(records[d].size() / RECORD_SIZE);
+        qToLittleEndian<quint32>(index, out + 8 + d * 8);
+        qToLittleEndian<quint32>(size, out + 12 + d * 8);
+        index += size;
+    }
+
+    file.write(header);
+    for (auto &bucket : records) {
+        file.write(bucket);
+    }
+    return file.commit();
+}
+}
@@ -0,0 +1,125 @@
+/*
+ * puzzlebank.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_PUZZLEBANK_H
+#define SUDOQU_PUZZLEBANK_H
+
+#include "grader.h"
+#include "sudoku.h"
+
+#include <QByteArray>
+#include <QFile>
+
+#include <array>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class PuzzleBank
+ * @brief A file of pre-generated puzzles, memory-mapped and sampled without parsing
+ *
+ * The file starts with a 48 bytes header: "SQPB", the format version, then for each
+ * difficulty the index of its first record and its number of records. Records are
+ * sorted by difficulty, 56 bytes each: the solution packed two squares per byte (41 bytes),
+ * a bit per square set for the givens (11 bytes), the rating (16 bits, little endian), the
+ * hardest technique and a reserved byte.
+ *
+ * Since the file is only mapped, opening a bank of millions of puzzles takes no time, and
+ * servers using the same bank share its pages.
+ */
+class PuzzleBank {
+public:
+    struct Entry {
+        std::vector<int> puzzle;
+        std::vector<int> solution;
+        SB::Difficulty difficulty = SB::UNKNOWN;
+        int rating = 0;
+        Technique hardest = NO_TECHNIQUE;
+    };
+
+    /**
+     * @brief maps a bank, closing the current one
+     * @param path the file
+     * @return false if the file is missing, is not a bank or is truncated
+     */
+    bool open(const QString &);
+
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @return the number of puzzles of a difficulty
+     */
+    int count(SB::Difficulty) const;
+
+    /**
+     * @brief reads a puzzle
+     * @param difficulty the difficulty
+     * @param index the puzzle's index within that difficulty, less than count()
+     * @return the puzzle, with an empty board if the index is out of range or the record is corrupt
+     */
+    Entry at(SB::Difficulty, int) const;
+
+    /**
+     * @brief picks a random puzzle
+     * @param difficulty the difficulty
+     * @param random the generator choosing the puzzle
+     * @param entry receives the puzzle
+     * @return false if the bank has no puzzle of that difficulty or the one picked is corrupt
+     */
+    bool sample(SB::Difficulty, Random &, Entry &) const;
+
+private:
+    QFile file;
+    const uchar *data = nullptr;
+
+    std::array<quint32, SB::EXPERT + 1> first{};
+    std::array<quint32, SB::EXPERT + 1> counts{};
+};
+
+/**
+ * @class PuzzleBankWriter
+ * @brief Builds a puzzle bank, keeping only the packed records in memory
+ */
+class PuzzleBankWriter {
+public:
+    /**
+     * @brief adds a puzzle, its difficulty decides where it is stored
+     */
+    void add(const PuzzleBank::Entry &);
+
+    /**
+     * @return the number of puzzles added
+     */
+    int size() const;
+
+    /**
+     * @brief writes the bank
+     * @param path the file
+     * @return false if the file could not be written
+     */
+    bool save(const QString &) const;
+
+private:
+    std::array<QByteArray, SB::EXPERT + 1> records;
+};
+}
+
+#endif
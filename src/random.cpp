@@ -0,0 +1,86 @@
+/*
+ * random.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "random.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+
+namespace Sudoqu {
+
+namespace {
+std::uint64_t splitmix64(std::uint64_t &x) {
+    std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+inline std::uint64_t rotl(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+}
+
+Random::Random() : Random(randomSeed()) {
+}
+
+Random::Random(std::uint64_t seed) {
+    for (std::uint64_t &word : state) {
+        word = splitmix64(seed);
+    }
+}
+
+std::uint64_t Random::next() {
+    const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+    const std::uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+
+    return result;
+}
+
+std::uint32_t Random::below(std::uint32_t bound) {
+    // Lemire's multiply-and-reject, unbiased without a division in the common case
+    std::uint64_t product = (next() >> 32) * bound;
+    std::uint32_t low = static_cast<std::uint32_t>(product);
+    if (low < bound) {
+        std::uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (next() >> 32) * bound;
+            low = static_cast<std::uint32_t>(product);
+        }
+    }
+    return static_cast<std::uint32_t>(product >> 32);
+}
+
+std::uint64_t Random::randomSeed() {
+    // random_device may be deterministic on some platforms, the clock and a counter keep seeds apart
+    static std::atomic<std::uint64_t> counter(0);
+    std::random_device device;
+    std::uint64_t seed = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    seed ^= static_cast<std::uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    std::uint64_t mixed = seed + counter.fetch_add(1) * 0x9e3779b97f4a7c15ull;
+    return splitmix64(mixed);
+}
+}
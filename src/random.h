@@ -0,0 +1,65 @@
+/*
+ * random.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_RANDOM_H
+#define SUDOQU_RANDOM_H
+
+#include <cstdint>
+
+namespace Sudoqu {
+
+/**
+ * @class Random
+ * @brief A small, fast pseudo-random generator (xoshiro256**)
+ *
+ * Each instance has its own state, so threads do not share or lock anything, and
+ * the same seed always gives the same sequence.
+ */
+class Random {
+public:
+    /**
+     * @brief seeds the generator from std::random_device and the clock
+     */
+    Random();
+
+    /**
+     * @param seed expanded into the full state with splitmix64, any value is fine
+     */
+    explicit Random(std::uint64_t);
+
+    /**
+     * @return the next 64 random bits
+     */
+    std::uint64_t next();
+
+    /**
+     * @return a number uniformly distributed in [0, bound), bound must be positive
+     */
+    std::uint32_t below(std::uint32_t);
+
+    /**
+     * @return a seed that differs between calls and between runs
+     */
+    static std::uint64_t randomSeed();
+
+private:
+    std::uint64_t state[4];
+};
+}
+
+#endif
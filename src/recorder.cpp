@@ -0,0 +1,312 @@
+/*
+ * recorder.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recorder.h"
+
+#include <QtEndian>
+
+namespace Sudoqu {
+
+namespace {
+const char MAGIC[4] = {'S', 'Q', 'R', 'P'};
+const quint8 RECORDING_VERSION = 1;
+
+/**
+ * @brief buffered records are written once they reach this size
+ */
+const int FLUSH_SIZE = 4096;
+
+const int BOARD_SIZE = 81;
+
+/**
+ * @brief a board packed two squares per byte
+ */
+const int PACKED_BOARD_SIZE = (BOARD_SIZE + 1) / 2;
+
+/**
+ * @brief stored in place of a position for "no square"
+ */
+const quint8 NO_POSITION = 0xff;
+
+void writeVarint(QByteArray &out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+void writeString(QByteArray &out, const QString &str) {
+    QByteArray utf8 = str.toUtf8();
+    writeVarint(out, static_cast<quint64>(utf8.size()));
+    out.append(utf8);
+}
+
+void writeBoard(QByteArray &out, const std::vector<int> &board) {
+    for (int i = 0; i < PACKED_BOARD_SIZE; ++i) {
+        size_t pos = static_cast<size_t>(i * 2);
+        int low = pos < board.size() ? board[pos] : 0;
+        int high = pos + 1 < board.size() ? board[pos + 1] : 0;
+        out.append(static_cast<char>((low & 0x0f) | ((high & 0x0f) << 4)));
+    }
+}
+
+/**
+ * @brief reads values from a recording, remembering if it ran past the end
+ */
+struct Reader {
+    const QByteArray &data;
+    int offset;
+    bool ok = true;
+
+    quint8 byte() {
+        if (offset >= data.size()) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<quint8>(data[offset++]);
+    }
+
+    quint64 varint() {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            quint8 b = byte();
+            value |= static_cast<quint64>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return value;
+    }
+
+    QString string() {
+        int size = static_cast<int>(varint());
+        if (size < 0 || offset + size > data.size()) {
+            ok = false;
+            return QString();
+        }
+        QString str = QString::fromUtf8(data.constData() + offset, size);
+        offset += size;
+        return str;
+    }
+
+    std::vector<int> board() {
+        std::vector<int> board(BOARD_SIZE);
+        for (int i = 0; i < PACKED_BOARD_SIZE; ++i) {
+            quint8 b = byte();
+            board[static_cast<size_t>(i * 2)] = b & 0x0f;
+            if (i * 2 + 1 < BOARD_SIZE) {
+                board[static_cast<size_t>(i * 2 + 1)] = b >> 4;
+            }
+        }
+        return board;
+    }
+};
+}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+bool Recorder::start(const QString &path, GameMode mode, const QStringList &teams, const std::vector<int> &puzzle,
+                     const std::vector<int> &solution) {
+    stop();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    buffer.clear();
+    buffer.append(MAGIC, sizeof(MAGIC));
+    buffer.append(static_cast<char>(RECORDING_VERSION));
+    buffer.append(static_cast<char>(mode));
+
+    char started[8];
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), reinterpret_cast<uchar *>(started));
+    buffer.append(started, sizeof(started));
+
+    writeVarint(buffer, static_cast<quint64>(teams.size()));
+    for (auto &team : teams) {
+        writeString(buffer, team);
+    }
+    writeBoard(buffer, puzzle);
+    writeBoard(buffer, solution);
+
+    clock.start();
+    last_event = 0;
+    flush(true);
+    return true;
+}
+
+void Recorder::stop() {
+    if (file.isOpen()) {
+        flush(true);
+        file.close();
+    }
+}
+
+bool Recorder::isRecording() const {
+    return file.isOpen();
+}
+
+void Recorder::begin(RecordedEvent type, int id) {
+    qint64 now = clock.elapsed();
+    writeVarint(buffer, static_cast<quint64>(now - last_event));
+    last_event = now;
+    buffer.append(static_cast<char>(type));
+    writeVarint(buffer, static_cast<quint64>(id));
+}
+
+void Recorder::join(int id, const QString &name, const QString &team) {
+    if (!isRecording()) {
+        return;
+    }
+    begin(RECORDED_JOIN, id);
+    writeString(buffer, name);
+    writeString(buffer, team);
+    flush(false);
+}
+
+void Recorder::value(int id, int pos, int value) {
+    if (!isRecording() || pos < 0 || pos >= BOARD_SIZE) {
+        return;
+    }
+    begin(RECORDED_VALUE, id);
+    buffer.append(static_cast<char>(pos));
+    buffer.append(static_cast<char>(value));
+    flush(false);
+}
+
+void Recorder::notes(int id, int pos, const std::vector<int> &notes) {
+    if (!isRecording() || pos < 0 || pos >= BOARD_SIZE) {
+        return;
+    }
+    quint64 mask = 0;
+    for (int note : notes) {
+        if (note >= 1 && note <= 9) {
+            mask |= 1u << (note - 1);
+        }
+    }
+    begin(RECORDED_NOTES, id);
+    buffer.append(static_cast<char>(pos));
+    writeVarint(buffer, mask);
+    flush(false);
+}
+
+void Recorder::focus(int id, int pos) {
+    // a square stored in one byte: anything else would be replayed as another square
+    if (!isRecording() || pos < -1 || pos >= BOARD_SIZE) {
+        return;
+    }
+    begin(RECORDED_FOCUS, id);
+    buffer.append(static_cast<char>(pos < 0 ? NO_POSITION : pos));
+    flush(false);
+}
+
+void Recorder::flush(bool force) {
+    if (force || buffer.size() >= FLUSH_SIZE) {
+        file.write(buffer);
+        file.flush();
+        buffer.clear();
+    }
+}
+
+bool Recording::open(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    if (data.size() < static_cast<int>(sizeof(MAGIC)) || !data.startsWith(QByteArray(MAGIC, sizeof(MAGIC)))) {
+        return false;
+    }
+
+    Reader in{data, sizeof(MAGIC)};
+    if (in.byte() != RECORDING_VERSION) {
+        return false;
+    }
+    mode = static_cast<GameMode>(in.byte());
+
+    uchar started_bytes[8];
+    for (uchar &b : started_bytes) {
+        b = in.byte();
+    }
+    started = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(started_bytes));
+
+    teams.clear();
+    quint64 team_count = in.varint();
+    for (quint64 i = 0; i < team_count && in.ok; ++i) {
+        teams.push_back(in.string());
+    }
+    puzzle = in.board();
+    solution = in.board();
+
+    if (!in.ok) {
+        return false;
+    }
+
+    events.clear();
+    qint64 time = 0;
+    while (in.offset < data.size()) {
+        Event event;
+        time += static_cast<qint64>(in.varint());
+        event.time = time;
+        event.type = static_cast<RecordedEvent>(in.byte());
+        event.player = static_cast<int>(in.varint());
+
+        switch (event.type) {
+        case RECORDED_JOIN:
+            event.name = in.string();
+            event.team = in.string();
+            break;
+        case RECORDED_VALUE:
+            event.pos = in.byte();
+            event.value = in.byte();
+            break;
+        case RECORDED_NOTES: {
+            event.pos = in.byte();
+            quint64 mask = in.varint();
+            for (int note = 1; note <= 9; ++note) {
+                if (mask & (1u << (note - 1))) {
+                    event.notes.push_back(note);
+                }
+            }
+            break;
+        }
+        case RECORDED_FOCUS: {
+            quint8 pos = in.byte();
+            event.pos = pos == NO_POSITION ? -1 : pos;
+            break;
+        }
+        default:
+            in.ok = false;
+        }
+
+        // the server may have stopped in the middle of a record
+        if (!in.ok) {
+            break;
+        }
+        events.push_back(std::move(event));
+    }
+
+    return true;
+}
+}
@@ -0,0 +1,154 @@
+/*
+ * recorder.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_RECORDER_H
+#define SUDOQU_RECORDER_H
+
+#include "constants.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @brief the kind of events stored in a game recording
+ */
+enum RecordedEvent : quint8 {
+    RECORDED_JOIN,
+    RECORDED_VALUE,
+    RECORDED_NOTES,
+    RECORDED_FOCUS,
+};
+
+/**
+ * @class Recorder
+ * @brief Writes the moves of a game to a compact binary file, for analysis and replay
+ *
+ * The file starts with the game's mode, teams, puzzle and solution, followed by one
+ * record per event: the milliseconds since the previous event and the player's id as
+ * varints, the event type, then a few bytes of payload.
+ */
+class Recorder {
+public:
+    ~Recorder();
+
+    /**
+     * @brief starts a new recording, closing the current one
+     * @param path the file to write
+     * @param mode the game mode
+     * @param teams the teams available in the game
+     * @param puzzle the puzzle
+     * @param solution its solution
+     * @return false if the file could not be created
+     */
+    bool start(const QString &, GameMode, const QStringList &, const std::vector<int> &, const std::vector<int> &);
+
+    /**
+     * @brief flushes and closes the recording
+     */
+    void stop();
+
+    bool isRecording() const;
+
+    /**
+     * @brief a player joined the game, or changed name or team
+     */
+    void join(int, const QString &, const QString &);
+
+    /**
+     * @brief a player entered a value
+     * @param id the player's id
+     * @param pos the square
+     * @param value the value
+     */
+    void value(int, int, int);
+
+    /**
+     * @brief a player changed the notes of a square
+     * @param id the player's id
+     * @param pos the square
+     * @param notes the notes
+     */
+    void notes(int, int, const std::vector<int> &);
+
+    /**
+     * @brief a player moved their focus
+     * @param id the player's id
+     * @param pos the focused square, -1 for none
+     */
+    void focus(int, int);
+
+private:
+    QFile file;
+
+    /**
+     * @brief records waiting to be written, flushed in blocks
+     */
+    QByteArray buffer;
+
+    QElapsedTimer clock;
+    qint64 last_event = 0;
+
+    void begin(RecordedEvent, int);
+    void flush(bool);
+};
+
+/**
+ * @class Recording
+ * @brief A game recording read back from a file
+ */
+class Recording {
+public:
+    struct Event {
+        /**
+         * @brief milliseconds since the game started
+         */
+        qint64 time = 0;
+
+        RecordedEvent type = RECORDED_JOIN;
+        int player = 0;
+        int pos = -1;
+        int value = 0;
+        std::vector<int> notes;
+        QString name;
+        QString team;
+    };
+
+    /**
+     * @brief reads a recording
+     * @param path the file to read
+     * @return false if the file is missing or is not a recording, a truncated tail is ignored
+     */
+    bool open(const QString &);
+
+    GameMode mode = NOT_PLAYING;
+    QStringList teams;
+    QDateTime started;
+    std::vector<int> puzzle;
+    std::vector<int> solution;
+    std::vector<Event> events;
+};
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * rendercache.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rendercache.h"
+
+#include <QPainter>
+#include <QPen>
+
+namespace Sudoqu {
+
+bool RenderCache::isValid(const QSize &s, qreal r) const {
+    return valid && size == s && qFuzzyCompare(ratio, r);
+}
+
+void RenderCache::invalidate() {
+    valid = false;
+}
+
+void RenderCache::rebuild(const QSize &s, qreal r, const ColorPalette &palette, const QFont &font,
+                          const QFont &notes_font) {
+    size = s;
+    ratio = r;
+
+    int width = size.width() / 9;
+    int height = size.height() / 9;
+    value_size = QSize(width, height);
+    note_size = QSize(width / 3, height / 3);
+
+    grid_pixmap = QPixmap(size * ratio);
+    grid_pixmap.setDevicePixelRatio(ratio);
+    grid_pixmap.fill(Qt::transparent);
+    QPainter painter(&grid_pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    drawGrid(painter, width, height, palette);
+    painter.end();
+
+    for (size_t role = 0; role < ColorPalette::ROLES; ++role) {
+        values[role] = renderDigits(value_size, font, palette.foreground[role]);
+        notes[role] = renderDigits(note_size, notes_font, palette.foreground[role]);
+    }
+
+    valid = true;
+}
+
+const QPixmap &RenderCache::grid() const {
+    return grid_pixmap;
+}
+
+void RenderCache::drawValue(QPainter &painter, const QRect &rect, int value, ColorPalette::Role role) const {
+    drawDigit(painter, values[role], value_size, rect, value);
+}
+
+void RenderCache::drawNote(QPainter &painter, const QRect &rect, int note, ColorPalette::Role role) const {
+    int x = rect.x() + ((note - 1) % 3) * note_size.width();
+    int y = rect.y() + ((note - 1) / 3) * note_size.height();
+    drawDigit(painter, notes[role], note_size, QRect(QPoint(x, y), note_size), note);
+}
+
+void RenderCache::drawGrid(QPainter &painter, int width, int height, const ColorPalette &palette) {
+    for (int i = 0; i <= 9; ++i) {
+        painter.setPen(i % 3 == 0 ? palette.outer_lines : palette.inner_lines);
+        painter.drawLine(width * i, 0, width * i, height * 9);
+    }
+
+    for (int i = 0; i <= 9; ++i) {
+        painter.setPen(i % 3 == 0 ? palette.outer_lines : palette.inner_lines);
+        painter.drawLine(0, height * i, width * 9, height * i);
+    }
+}
+
+QPixmap RenderCache::renderDigits(const QSize &glyph, const QFont &font, const QPen &pen) const {
+    QPixmap atlas(QSize(glyph.width() * 9, glyph.height()) * ratio);
+    atlas.setDevicePixelRatio(ratio);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(font);
+    painter.setPen(pen);
+    for (int digit = 1; digit <= 9; ++digit) {
+        QRect rect((digit - 1) * glyph.width(), 0, glyph.width(), glyph.height());
+        painter.drawText(rect, Qt::AlignVCenter | Qt::AlignCenter, QString::number(digit));
+    }
+    return atlas;
+}
+
+void RenderCache::drawDigit(QPainter &painter, const QPixmap &atlas, const QSize &glyph, const QRect &rect,
+                            int digit) const {
+    if (digit < 1 || digit > 9) {
+        return;
+    }
+
+    QRectF source((digit - 1) * glyph.width() * ratio, 0, glyph.width() * ratio, glyph.height() * ratio);
+    painter.drawPixmap(QRectF(rect.topLeft(), glyph), atlas, source);
+}
+}
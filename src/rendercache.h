@@ -0,0 +1,117 @@
+/*
+ * rendercache.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_RENDERCACHE_H
+#define SUDOQU_RENDERCACHE_H
+
+#include "colortheme.h"
+
+#include <QColor>
+#include <QFont>
+#include <QPixmap>
+
+#include <array>
+
+class QPainter;
+
+namespace Sudoqu {
+
+/**
+ * @class RenderCache
+ * @brief Pre-rendered pieces of the board, so painting a square is a fill and a blit
+ *
+ * Holds the grid lines drawn once for the current size, and an atlas of the digits 1 to 9
+ * for each foreground colour of the palette, at the size of a square and at the size of a note.
+ * It has to be rebuilt when the board is resized or the theme changes.
+ */
+class RenderCache {
+public:
+    /**
+     * @return true if the cache was built for this size and pixel ratio
+     */
+    bool isValid(const QSize &, qreal) const;
+
+    /**
+     * @brief discards the cached pixmaps, the next paint rebuilds them
+     */
+    void invalidate();
+
+    /**
+     * @brief renders the grid and the digits
+     * @param size the size of the board
+     * @param ratio the device pixel ratio of the widget
+     * @param palette the colours
+     * @param font the font of the values
+     * @param notes_font the font of the notes
+     */
+    void rebuild(const QSize &, qreal, const ColorPalette &, const QFont &, const QFont &);
+
+    /**
+     * @return the grid lines on a transparent background, covering the whole board
+     */
+    const QPixmap &grid() const;
+
+    /**
+     * @brief draws a value in a square
+     * @param painter the painter
+     * @param rect the square
+     * @param value the value, 1 to 9
+     * @param role the state of the square
+     */
+    void drawValue(QPainter &, const QRect &, int, ColorPalette::Role) const;
+
+    /**
+     * @brief draws a note in its ninth of a square
+     * @param painter the painter
+     * @param rect the square
+     * @param note the note, 1 to 9
+     * @param role the state of the square
+     */
+    void drawNote(QPainter &, const QRect &, int, ColorPalette::Role) const;
+
+    /**
+     * @brief draws the grid lines of a board
+     * @param painter the painter
+     * @param width the width of a square
+     * @param height the height of a square
+     * @param palette the colours
+     */
+    static void drawGrid(QPainter &, int, int, const ColorPalette &);
+
+private:
+    bool valid = false;
+    QSize size;
+    qreal ratio = 1;
+
+    QPixmap grid_pixmap;
+
+    QSize value_size;
+    QSize note_size;
+
+    /**
+     * @brief the digits side by side, in the foreground colour of each role
+     */
+    std::array<QPixmap, ColorPalette::ROLES> values;
+    std::array<QPixmap, ColorPalette::ROLES> notes;
+
+    QPixmap renderDigits(const QSize &, const QFont &, const QPen &) const;
+    void drawDigit(QPainter &, const QPixmap &, const QSize &, const QRect &, int) const;
+};
+}
+
+#endif
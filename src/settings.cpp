@@ -19,6 +19,7 @@
 #include "settings.h"
 
 #include <QDebug>
+#include <QStandardPaths>
 
 namespace Sudoqu {
 
@@ -73,6 +74,23 @@ void Settings::setNotesEnabled(bool enabled) {
     this->setValue("notesEnabled", enabled);
 }
 
+quint16 Settings::getMetricsPort() const {
+    return static_cast<quint16>(this->value("metricsPort", 0).toUInt());
+}
+
+QString Settings::getJournalDirectory() const {
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal";
+    return this->value("journalDirectory", directory).toString();
+}
+
+QString Settings::getRecordingDirectory() const {
+    return this->value("recordingDirectory", "").toString();
+}
+
+QString Settings::getPuzzleBank() const {
+    return this->value("puzzleBank", "").toString();
+}
+
 ColorTheme Settings::getColorTheme() {
     return value("colors", QVariant::fromValue(ColorTheme())).value<ColorTheme>();
 }
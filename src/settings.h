@@ -43,6 +43,26 @@ public:
 
     bool getNotesEnabled() const;
     void setNotesEnabled(bool);
+
+    /**
+     * @return the port of the server metrics endpoint, 0 when disabled
+     */
+    quint16 getMetricsPort() const;
+
+    /**
+     * @return where the server journals its games so they survive a restart, empty when disabled
+     */
+    QString getJournalDirectory() const;
+
+    /**
+     * @return where the server records the games it hosts, empty when disabled
+     */
+    QString getRecordingDirectory() const;
+
+    /**
+     * @return the puzzle bank the server picks its puzzles from, empty to generate them
+     */
+    QString getPuzzleBank() const;
 };
 }
 
@@ -0,0 +1,69 @@
+/*
+ * solutioncache.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "solutioncache.h"
+#include "isomorph.h"
+
+namespace Sudoqu {
+
+namespace {
+/**
+ * @brief puzzles kept in the cache
+ */
+const size_t CAPACITY = 256;
+}
+
+SolutionCache &SolutionCache::instance() {
+    static SolutionCache cache;
+    return cache;
+}
+
+bool SolutionCache::find(const std::vector<int> &puzzle, std::vector<int> &solution) {
+    std::uint64_t hash = Isomorph::hash(puzzle);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = by_hash.find(hash);
+    if (it == by_hash.end() || it->second->puzzle != puzzle) {
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    solution = it->second->solution;
+    return true;
+}
+
+void SolutionCache::insert(const std::vector<int> &puzzle, const std::vector<int> &solution) {
+    std::uint64_t hash = Isomorph::hash(puzzle);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = by_hash.find(hash);
+    if (it != by_hash.end()) {
+        it->second->puzzle = puzzle;
+        it->second->solution = solution;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    if (entries.size() >= CAPACITY) {
+        by_hash.erase(entries.back().hash);
+        entries.pop_back();
+    }
+    entries.push_front(Entry{hash, puzzle, solution});
+    by_hash[hash] = entries.begin();
+}
+}
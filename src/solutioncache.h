@@ -0,0 +1,72 @@
+/*
+ * solutioncache.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_SOLUTIONCACHE_H
+#define SUDOQU_SOLUTIONCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class SolutionCache
+ * @brief The solutions of the puzzles seen recently by the process, most recently used first
+ *
+ * Puzzles are looked up by their hash (Isomorph::hash), then compared in full, so a collision
+ * is a miss. The cache is shared by every thread of the process.
+ */
+class SolutionCache {
+public:
+    /**
+     * @return the cache of the process
+     */
+    static SolutionCache &instance();
+
+    /**
+     * @brief looks up the solution of a puzzle
+     * @param puzzle the puzzle
+     * @param solution receives the solution
+     * @return false if the puzzle is not in the cache
+     */
+    bool find(const std::vector<int> &, std::vector<int> &);
+
+    /**
+     * @brief remembers the solution of a puzzle, forgetting the least recently used one if full
+     * @param puzzle the puzzle
+     * @param solution its solution
+     */
+    void insert(const std::vector<int> &, const std::vector<int> &);
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        std::vector<int> puzzle;
+        std::vector<int> solution;
+    };
+
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> by_hash;
+};
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * solver.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "solver.h"
+#include "units.h"
+
+namespace Sudoqu {
+
+namespace {
+const int BOARD_SIZE = 81;
+}
+
+Solver::Solver(const std::vector<int> &puzzle) {
+    start.cells.fill(0);
+    start.candidates.fill(ALL_DIGITS);
+    start.empty = BOARD_SIZE;
+
+    if (puzzle.size() != static_cast<size_t>(BOARD_SIZE)) {
+        valid = false;
+        return;
+    }
+
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        int value = puzzle[static_cast<size_t>(pos)];
+        if (value == 0) {
+            continue;
+        }
+        if (value < 0 || value > 9 || !(start.candidates[pos] & digitBit(value))) {
+            valid = false;
+            return;
+        }
+        // a peer running out of candidates is not a conflict between givens, search() will find it
+        place(start, pos, value);
+    }
+}
+
+bool Solver::isValid() const {
+    return valid;
+}
+
+int Solver::countSolutions(int limit) {
+    found = 0;
+    solution.clear();
+    if (!valid || limit <= 0) {
+        return 0;
+    }
+
+    this->limit = limit;
+    State state = start;
+    search(state);
+    return found;
+}
+
+const std::vector<int> &Solver::getSolution() const {
+    return solution;
+}
+
+void Solver::search(State &state) {
+    if (!propagate(state)) {
+        return;
+    }
+
+    if (state.empty == 0) {
+        if (found++ == 0) {
+            solution.assign(state.cells.begin(), state.cells.end());
+        }
+        return;
+    }
+
+    int best = -1;
+    int best_count = 10;
+    for (int pos = 0; pos < BOARD_SIZE && best_count > 2; ++pos) {
+        if (!state.cells[pos]) {
+            int count = popcount(state.candidates[pos]);
+            if (count < best_count) {
+                best = pos;
+                best_count = count;
+            }
+        }
+    }
+
+    std::uint16_t mask = state.candidates[best];
+    while (mask && found < limit) {
+        int digit = lowestDigit(mask);
+        mask = static_cast<std::uint16_t>(mask & (mask - 1));
+
+        State next = state;
+        if (place(next, best, digit)) {
+            search(next);
+        }
+    }
+}
+
+bool Solver::place(State &state, int pos, int digit) {
+    std::uint16_t bit = digitBit(digit);
+    state.cells[pos] = static_cast<std::uint8_t>(digit);
+    state.candidates[pos] = 0;
+    --state.empty;
+
+    bool ok = true;
+    for (int peer : boardUnits().peers[pos]) {
+        if (!state.cells[peer]) {
+            state.candidates[peer] &= static_cast<std::uint16_t>(~bit);
+            ok = ok && state.candidates[peer] != 0;
+        }
+    }
+    return ok;
+}
+
+bool Solver::propagate(State &state) {
+    const BoardUnits &t = boardUnits();
+
+    while (true) {
+        // naked singles are cheap to find, place them all before looking for hidden ones
+        bool placed_single = true;
+        while (placed_single) {
+            placed_single = false;
+            for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+                std::uint16_t mask = state.candidates[pos];
+                if (!state.cells[pos] && (mask & (mask - 1)) == 0) {
+                    if (mask == 0 || !place(state, pos, lowestDigit(mask))) {
+                        return false;
+                    }
+                    placed_single = true;
+                }
+            }
+        }
+
+        bool placed_hidden = false;
+        for (auto &unit : t.units) {
+            std::uint16_t once = 0, twice = 0, placed = 0;
+            for (int pos : unit) {
+                if (state.cells[pos]) {
+                    placed |= digitBit(state.cells[pos]);
+                } else {
+                    twice = static_cast<std::uint16_t>(twice | (once & state.candidates[pos]));
+                    once |= state.candidates[pos];
+                }
+            }
+
+            if ((once | placed) != ALL_DIGITS) {
+                return false;
+            }
+
+            std::uint16_t hidden = static_cast<std::uint16_t>(once & ~twice);
+            while (hidden) {
+                int digit = lowestDigit(hidden);
+                hidden = static_cast<std::uint16_t>(hidden & (hidden - 1));
+                for (int pos : unit) {
+                    if (!state.cells[pos] && (state.candidates[pos] & digitBit(digit))) {
+                        if (!place(state, pos, digit)) {
+                            return false;
+                        }
+                        placed_hidden = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!placed_hidden) {
+            return true;
+        }
+    }
+}
+}
@@ -0,0 +1,95 @@
+/*
+ * solver.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_SOLVER_H
+#define SUDOQU_SOLVER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class Solver
+ * @brief Backtracking solver working on bitmasks of the digits used in each row, column and box
+ *
+ * Naked and hidden singles are placed until none are left, then the search branches on the
+ * empty square with the fewest candidates. Counting stops as soon as the limit is reached,
+ * which makes checking that a puzzle has a unique solution cost about as much as solving it.
+ */
+class Solver {
+public:
+    /**
+     * @param puzzle the 81 squares of the puzzle, 0 for an empty square
+     */
+    explicit Solver(const std::vector<int> &);
+
+    /**
+     * @return false if the puzzle is not 81 squares of 0 to 9, or if two givens conflict
+     */
+    bool isValid() const;
+
+    /**
+     * @brief counts the solutions of the puzzle
+     * @param limit stop counting after this many solutions
+     * @return the number of solutions found, at most limit
+     */
+    int countSolutions(int = 2);
+
+    /**
+     * @return the first solution found by countSolutions(), empty if there was none
+     */
+    const std::vector<int> &getSolution() const;
+
+private:
+    struct State {
+        std::array<std::uint8_t, 81> cells;
+
+        /**
+         * @brief the digits still possible in each empty square, bit n - 1 for digit n
+         */
+        std::array<std::uint16_t, 81> candidates;
+
+        int empty;
+    };
+
+    State start;
+    bool valid = true;
+    int found = 0;
+    int limit = 0;
+    std::vector<int> solution;
+
+    void search(State &);
+
+    /**
+     * @brief places a digit and removes it from the candidates of the square's peers
+     * @return false if a peer is left without candidates
+     */
+    static bool place(State &, int, int);
+
+    /**
+     * @brief places naked and hidden singles until there are none left
+     * @return false if the board has no solution
+     */
+    static bool propagate(State &);
+};
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * statusmodel.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "statusmodel.h"
+
+#include <QBrush>
+#include <QFont>
+
+#include <algorithm>
+
+namespace Sudoqu {
+
+StatusModel::StatusModel(QObject *parent) : QAbstractListModel(parent) {
+}
+
+int StatusModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+QVariant StatusModel::data(const QModelIndex &idx, int role) const {
+    if (!idx.isValid() || idx.row() >= static_cast<int>(rows.size())) {
+        return QVariant();
+    }
+
+    const StatusChange &status = rows[static_cast<size_t>(idx.row())];
+
+    switch (role) {
+    case Qt::DisplayRole: {
+        QString text = status.name;
+        if (count_total > 0) {
+            text += QString(" (%1 / %2)").arg(status.count).arg(count_total);
+        }
+        if (status.latency >= 0) {
+            text += QString(" %1 %2 ms").arg(QChar(0x2014)).arg(status.latency);
+        }
+        return text;
+    }
+
+    case Qt::ForegroundRole:
+        if (active && status.count == count_total) {
+            return QBrush(status.done ? Qt::green : Qt::red);
+        }
+        return QVariant();
+
+    case Qt::FontRole: {
+        QFont font;
+        font.setBold(true);
+        return font;
+    }
+    }
+
+    return QVariant();
+}
+
+void StatusModel::apply(const StatusChange &status) {
+    auto found = rows_by_name.find(status.name);
+    if (found == rows_by_name.end()) {
+        auto place = std::lower_bound(rows.begin(), rows.end(), status, before);
+        int row = static_cast<int>(place - rows.begin());
+        beginInsertRows(QModelIndex(), row, row);
+        rows.insert(place, status);
+        endInsertRows();
+        reindex(row, static_cast<int>(rows.size()) - 1);
+        rows_by_name[status.name].seen = true;
+        return;
+    }
+
+    found->second.seen = true;
+    int row = found->second.row;
+    StatusChange &current = rows[static_cast<size_t>(row)];
+    if (current.count == status.count && current.done == status.done && current.latency == status.latency) {
+        return;
+    }
+
+    current = status;
+    emit dataChanged(index(row), index(row));
+    resort(row);
+}
+
+void StatusModel::finish(int total, bool a) {
+    bool all_changed = total != count_total || a != active;
+    count_total = total;
+    active = a;
+
+    for (int row = static_cast<int>(rows.size()) - 1; row >= 0; --row) {
+        auto found = rows_by_name.find(rows[static_cast<size_t>(row)].name);
+        if (!found->second.seen) {
+            beginRemoveRows(QModelIndex(), row, row);
+            rows_by_name.erase(found);
+            rows.erase(rows.begin() + row);
+            endRemoveRows();
+            reindex(row, static_cast<int>(rows.size()) - 1);
+        }
+    }
+
+    for (auto &name : rows_by_name) {
+        name.second.seen = false;
+    }
+
+    if (all_changed && !rows.empty()) {
+        emit dataChanged(index(0), index(static_cast<int>(rows.size()) - 1));
+    }
+}
+
+void StatusModel::clear() {
+    beginResetModel();
+    rows.clear();
+    rows_by_name.clear();
+    count_total = 0;
+    active = false;
+    endResetModel();
+}
+
+bool StatusModel::before(const StatusChange &a, const StatusChange &b) {
+    if (a.count == b.count) {
+        return a.name > b.name;
+    }
+    return a.count > b.count;
+}
+
+void StatusModel::resort(int row) {
+    auto moving = rows.begin() + row;
+
+    int target = row;
+    while (target > 0 && before(*moving, rows[static_cast<size_t>(target - 1)])) {
+        --target;
+    }
+    while (target < static_cast<int>(rows.size()) - 1 && before(rows[static_cast<size_t>(target + 1)], *moving)) {
+        ++target;
+    }
+
+    if (target == row) {
+        return;
+    }
+
+    // when moving down, Qt expects the row it will be inserted before
+    beginMoveRows(QModelIndex(), row, row, QModelIndex(), target > row ? target + 1 : target);
+    if (target < row) {
+        std::rotate(rows.begin() + target, moving, moving + 1);
+    } else {
+        std::rotate(moving, moving + 1, rows.begin() + target + 1);
+    }
+    endMoveRows();
+    reindex(std::min(row, target), std::max(row, target));
+}
+
+void StatusModel::reindex(int first, int last) {
+    for (int row = first; row <= last; ++row) {
+        rows_by_name[rows[static_cast<size_t>(row)].name].row = row;
+    }
+}
+}
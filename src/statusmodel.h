@@ -0,0 +1,102 @@
+/*
+ * statusmodel.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_STATUSMODEL_H
+#define SUDOQU_STATUSMODEL_H
+
+#include "network.h"
+
+#include <QAbstractListModel>
+
+#include <map>
+#include <vector>
+
+namespace Sudoqu {
+
+/**
+ * @class StatusModel
+ * @brief The players / teams shown in the game status pane, best score first
+ *
+ * Each STATUS_CHANGE is applied by name, one player / team at a time: only the rows that
+ * changed are updated, moved to their new place, inserted or removed, so the view repaints just those.
+ */
+class StatusModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit StatusModel(QObject * = nullptr);
+
+    int rowCount(const QModelIndex & = QModelIndex()) const override;
+    QVariant data(const QModelIndex &, int = Qt::DisplayRole) const override;
+
+    /**
+     * @brief applies the status of one player / team received from the server
+     * @param status the player / team's status
+     */
+    void apply(const StatusChange &);
+
+    /**
+     * @brief ends a status update, removing the players / teams it did not list
+     * @param count_total the number of squares to fill, 0 if no game is running
+     * @param active true if a game is being played
+     */
+    void finish(int, bool);
+
+    /**
+     * @brief removes all the rows
+     */
+    void clear();
+
+private:
+    std::vector<StatusChange> rows;
+
+    struct Index {
+        int row = 0;
+
+        /**
+         * @brief listed in the current status update
+         */
+        bool seen = false;
+    };
+
+    /**
+     * @brief row of each name
+     */
+    std::map<QString, Index> rows_by_name;
+
+    int count_total = 0;
+    bool active = false;
+
+    /**
+     * @return true if a should be listed before b
+     */
+    static bool before(const StatusChange &, const StatusChange &);
+
+    /**
+     * @brief moves a row to its place in the order, after its values changed
+     */
+    void resort(int);
+
+    /**
+     * @brief updates the index of the names from row first to row last
+     */
+    void reindex(int, int);
+};
+}
+
+#endif
@@ -17,12 +17,14 @@
  */
 
 #include "sudoku.h"
-
-#include <qqwing.hpp>
+#include "generator.h"
+#include "isomorph.h"
+#include "solutioncache.h"
+#include "solver.h"
 
 #include <QDebug>
 
-#include <ctime>
+#include <algorithm>
 #include <vector>
 
 namespace Sudoqu {
@@ -30,32 +32,41 @@ namespace Sudoqu {
 Sudoku::Sudoku() {
 }
 
-void Sudoku::generate(SB::Difficulty difficulty) {
-    bool boardDone = false;
-    srand(unsigned(time(0)));
-    board.setRecordHistory(true);
-
-    while (!boardDone) {
-        boardDone = board.generatePuzzle();
-        board.solve();
-        if (board.getDifficulty() != difficulty) {
-            boardDone = false;
-        }
-    }
+Sudoku::Sudoku(std::uint64_t seed) : random(seed) {
+}
 
-    const int *_puzzle = board.getPuzzle();
-    const int *_solution = board.getSolution();
+void Sudoku::generate(SB::Difficulty difficulty, int givens) {
+    Generator generator(random);
+    generator.generate(difficulty, givens);
 
-    puzzle.assign(_puzzle, _puzzle + qqwing::BOARD_SIZE);
-    solution.assign(_solution, _solution + qqwing::BOARD_SIZE);
+    puzzle = generator.getPuzzle();
+    solution = generator.getSolution();
+    SolutionCache::instance().insert(puzzle, solution);
 }
 
 void Sudoku::setBoard(std::vector<int> &board) {
-    this->board.setPuzzle(&board[0]);
-    this->board.solve();
+    puzzle = board;
+    if (SolutionCache::instance().find(puzzle, solution)) {
+        return;
+    }
+
+    Solver solver(puzzle);
+    solver.countSolutions(1);
+    solution = solver.getSolution();
+    SolutionCache::instance().insert(puzzle, solution);
+}
+
+void Sudoku::setBoard(const std::vector<int> &puzzle, const std::vector<int> &solution) {
+    this->puzzle = puzzle;
+    this->solution = solution;
+    SolutionCache::instance().insert(puzzle, solution);
+}
 
-    const int *_solution = this->board.getSolution();
-    solution.assign(_solution, _solution + qqwing::BOARD_SIZE);
+void Sudoku::shuffle(std::uint64_t random) {
+    Isomorph isomorph(random);
+    puzzle = isomorph.apply(puzzle);
+    solution = isomorph.apply(solution);
+    SolutionCache::instance().insert(puzzle, solution);
 }
 
 const std::vector<int> &Sudoku::getPuzzle() const {
@@ -66,7 +77,44 @@ const std::vector<int> &Sudoku::getSolution() const {
     return solution;
 }
 
-int Sudoku::getGivenCount() {
-    return board.getGivenCount();
+int Sudoku::getGivenCount() const {
+    return static_cast<int>(std::count_if(puzzle.begin(), puzzle.end(), [](int value) { return value > 0; }));
+}
+
+bool Sudoku::hasUniqueSolution() const {
+    return countSolutions(puzzle) == 1;
+}
+
+int Sudoku::countSolutions(const std::vector<int> &puzzle, int limit) {
+    Solver solver(puzzle);
+    return solver.countSolutions(limit);
+}
+
+Grade Sudoku::grade() const {
+    Grader grader(puzzle);
+    return grader.grade();
+}
+
+std::uint64_t Sudoku::canonicalHash(const std::vector<int> &puzzle) {
+    return Isomorph::hash(Isomorph::canonical(puzzle));
+}
+
+SB::Difficulty Sudoku::difficulty(const Grade &grade) {
+    switch (grade.hardest) {
+    case NO_TECHNIQUE:
+    case HIDDEN_SINGLE:
+        return SB::SIMPLE;
+    case NAKED_SINGLE:
+        return SB::EASY;
+    case LOCKED_CANDIDATES:
+    case NAKED_PAIR:
+    case X_WING:
+    case HIDDEN_PAIR:
+        return SB::INTERMEDIATE;
+    case XY_CHAIN:
+    case GUESSING:
+        return SB::EXPERT;
+    }
+    return SB::UNKNOWN;
+}
 }
-}
\ No newline at end of file
@@ -19,8 +19,12 @@
 #ifndef SUDOQU_SUDOKU_H
 #define SUDOQU_SUDOKU_H
 
+#include "grader.h"
+#include "random.h"
+
 #include <qqwing.hpp>
 
+#include <cstdint>
 #include <vector>
 
 namespace Sudoqu {
@@ -28,23 +32,49 @@ namespace Sudoqu {
 using SB = qqwing::SudokuBoard;
 
 /**
- * @brief The Sudoku class, a wrapper around the qqwing library
+ * @brief The Sudoku class: a puzzle and its solution, generated or assigned
+ * the difficulty levels are the ones of the qqwing library
  */
 class Sudoku {
 public:
+    /**
+     * @brief a board whose generated puzzles differ from run to run
+     */
     Sudoku();
+
+    /**
+     * @brief a board generating the same puzzles, in the same order, for the same seed
+     * @param seed seeds the board's random generator
+     */
+    explicit Sudoku(std::uint64_t);
+
     /**
-     * @brief generate a new Sudoku board
+     * @brief generate a new Sudoku board, see Sudoqu::Generator
      * @param difficulty how difficult we want the board to be
+     * @param givens the number of givens to aim for, 0 for as few as possible
      */
-    void generate(SB::Difficulty = SB::EASY);
+    void generate(SB::Difficulty = SB::EASY, int = 0);
 
     /**
-     * @brief assign a puzzle to the board
+     * @brief assign a puzzle to the board, solving it unless it is in the solution cache
      * @param board the puzzle we want to assign
      */
     void setBoard(std::vector<int> &);
 
+    /**
+     * @brief assign a puzzle whose solution is already known, without solving it
+     * @param puzzle the puzzle we want to assign
+     * @param solution the solution to that puzzle
+     */
+    void setBoard(const std::vector<int> &, const std::vector<int> &);
+
+    /**
+     * @brief replaces the puzzle and its solution with an equivalent board, see Sudoqu::Isomorph
+     * the new puzzle looks different but has the same difficulty
+     * @param random picks the transformation
+     */
+    void shuffle(std::uint64_t);
+
     /**
      * @return the current puzzle
      */
@@ -58,13 +88,43 @@ public:
     /**
      * @return the number of givens for the current board;
      */
-    int getGivenCount();
+    int getGivenCount() const;
 
-private:
     /**
-     * @brief a sudoku board (qqwing library)
+     * @return true if the current puzzle has exactly one solution
      */
-    qqwing::SudokuBoard board;
+    bool hasUniqueSolution() const;
+
+    /**
+     * @brief counts the solutions of a puzzle, stopping as soon as the limit is reached
+     * @param puzzle the puzzle, 0 for an empty square
+     * @param limit stop counting after this many solutions
+     * @return the number of solutions, at most limit, 0 if the puzzle is invalid
+     */
+    static int countSolutions(const std::vector<int> &, int = 2);
+
+    /**
+     * @brief rates how hard the current puzzle is for a human, see Sudoqu::Grader
+     * @return the rating and the hardest technique needed
+     */
+    Grade grade() const;
+
+    /**
+     * @brief maps a grade to the difficulties offered to players
+     * @param grade the grade of a puzzle
+     * @return the difficulty, from the hardest technique needed
+     */
+    static SB::Difficulty difficulty(const Grade &);
+
+    /**
+     * @brief hashes the canonical form of a puzzle, see Sudoqu::Isomorph::canonical
+     * @param puzzle the puzzle
+     * @return the same hash for all the puzzles equivalent to this one
+     */
+    static std::uint64_t canonicalHash(const std::vector<int> &);
+
+private:
+    Random random;
 
     /**
      * @brief the current puzzle
@@ -0,0 +1,52 @@
+/*
+ * units.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "units.h"
+
+namespace Sudoqu {
+
+BoardUnits::BoardUnits() {
+    for (int pos = 0; pos < 81; ++pos) {
+        row[pos] = pos / 9;
+        col[pos] = pos % 9;
+        box[pos] = (pos / 27) * 3 + (pos % 9) / 3;
+    }
+
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 9; ++j) {
+            units[i][j] = i * 9 + j;
+            units[9 + i][j] = j * 9 + i;
+            units[18 + i][j] = (i / 3) * 27 + (i % 3) * 3 + (j / 3) * 9 + j % 3;
+        }
+    }
+
+    for (int pos = 0; pos < 81; ++pos) {
+        int count = 0;
+        for (int other = 0; other < 81; ++other) {
+            if (other != pos && (row[other] == row[pos] || col[other] == col[pos] || box[other] == box[pos])) {
+                peers[pos][count++] = other;
+            }
+        }
+    }
+}
+
+const BoardUnits &boardUnits() {
+    static const BoardUnits tables;
+    return tables;
+}
+}
@@ -0,0 +1,74 @@
+/*
+ * units.h
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOQU_UNITS_H
+#define SUDOQU_UNITS_H
+
+#include <cstdint>
+
+namespace Sudoqu {
+
+/**
+ * @struct BoardUnits
+ * @brief The rows, columns and boxes of a 9x9 board, and which of them each square belongs to
+ */
+struct BoardUnits {
+    /**
+     * @brief the squares of the 27 units: rows 0 to 8, columns 9 to 17, boxes 18 to 26
+     */
+    int units[27][9];
+
+    /**
+     * @brief the 20 squares sharing a row, a column or a box with each square
+     */
+    int peers[81][20];
+
+    int row[81];
+    int col[81];
+    int box[81];
+
+    BoardUnits();
+};
+
+/**
+ * @return the tables, built on first use
+ */
+const BoardUnits &boardUnits();
+
+/**
+ * @return the bit of a digit in a candidate mask, bit n - 1 for digit n
+ */
+inline std::uint16_t digitBit(int digit) {
+    return static_cast<std::uint16_t>(1u << (digit - 1));
+}
+
+/**
+ * @return the smallest digit in a candidate mask, which must not be empty
+ */
+inline int lowestDigit(std::uint16_t mask) {
+    return __builtin_ctz(mask) + 1;
+}
+
+inline int popcount(std::uint16_t mask) {
+    return __builtin_popcount(mask);
+}
+
+const std::uint16_t ALL_DIGITS = 0x1ff;
+}
+
+#endif
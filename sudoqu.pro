@@ -1,50 +1,23 @@
-QT += core gui widgets network
+TEMPLATE = subdirs
 
-CONFIG += c++14
+SUBDIRS +=  client \
+            app \
+            replay \
+            bot \
+            puzzles
 
-TARGET = sudoqu
-TEMPLATE = app
+client.file = client/client.pro
 
-SOURCES +=  src/main.cpp\
-            src/mainwindow.cpp \
-            src/gameframe.cpp \
-            src/game.cpp \
-            src/player.cpp \
-            src/sudoku.cpp \
-            src/network.cpp \
-            src/connectdialog.cpp \
-            src/chatbox.cpp \
-            src/settings.cpp \
-            src/colortheme.cpp \
-            src/colorthemedialog.cpp
+app.file = app/app.pro
+app.depends = client
 
-HEADERS  += src/mainwindow.h \
-            src/gameframe.h \
-            src/game.h \
-            src/player.h \
-            src/sudoku.h \
-            src/network.h \
-            src/connectdialog.h \
-            src/chatbox.h \
-            src/settings.h \
-            src/constants.h \
-            src/colortheme.h \
-            src/colorthemedialog.h
+replay.file = tools/replay/replay.pro
+replay.depends = client
 
-FORMS    += ui/mainwindow.ui \
-            ui/connectdialog.ui \
-            ui/colorthemedialog.ui
+bot.file = tools/bot/bot.pro
+bot.depends = client
 
-VERSION = "0.2.2"
-
-DEFINES += VERSION=\\\"$$VERSION\\\"
-
-CONFIG(debug, debug|release){
-    DEFINES += DEBUG
-}
-
-CONFIG += link_pkgconfig
-PKGCONFIG += qqwing
+puzzles.file = tools/puzzles/puzzles.pro
 
 docs.commands = rm -rf doc/ && (cat $$_PRO_FILE_PWD_/Doxyfile; echo "INPUT=$$_PRO_FILE_PWD_/src") | doxygen -
 QMAKE_EXTRA_TARGETS = docs
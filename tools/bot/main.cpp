@@ -0,0 +1,172 @@
+/*
+ * main.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * sudoqu-bot: connects automated players to a Sudoqu server, to practice against
+ * or to load a server with many clients. Each bot solves the puzzle and enters the
+ * solution one square at a time.
+ */
+
+#include "player.h"
+#include "sudoku.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+using namespace Sudoqu;
+
+namespace {
+
+struct Bot {
+    std::unique_ptr<Player, PlayerDeleter> player;
+    QTimer timer;
+    std::vector<int> given;
+    std::vector<int> board;
+    std::vector<int> solution;
+    bool connected = false;
+};
+
+/**
+ * @brief focuses a random square that is not solved yet, and enters its value
+ * @return false if the board is complete
+ */
+bool play(Bot &bot) {
+    std::vector<int> todo;
+    for (size_t pos = 0; pos < bot.board.size() && pos < bot.solution.size(); ++pos) {
+        if (bot.given[pos] == 0 && bot.board[pos] != bot.solution[pos]) {
+            todo.push_back(static_cast<int>(pos));
+        }
+    }
+    if (todo.empty()) {
+        return false;
+    }
+
+    int pos = todo[static_cast<size_t>(qrand()) % todo.size()];
+    bot.board[static_cast<size_t>(pos)] = bot.solution[static_cast<size_t>(pos)];
+    bot.player->sendFocusedSquare(pos);
+    bot.player->sendValue(pos, bot.solution[static_cast<size_t>(pos)]);
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sudoqu-bot");
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Connects automated players to a Sudoqu server");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption clients(QStringList() << "c" << "clients", "Connect <n> bots.", "n", "1");
+    QCommandLineOption delay(QStringList() << "d" << "delay", "Wait <ms> between two moves of a bot.", "ms", "1000");
+    QCommandLineOption team(QStringList() << "t" << "team", "Join <team> in coop games.", "team");
+    QCommandLineOption name("name", "Name the bots <name> 1, <name> 2...", "name", "Bot");
+    parser.addOption(clients);
+    parser.addOption(delay);
+    parser.addOption(team);
+    parser.addOption(name);
+    parser.addPositionalArgument("host", "The server to connect to (default: localhost).");
+    parser.process(app);
+
+    QString host = parser.positionalArguments().isEmpty() ? "localhost" : parser.positionalArguments().first();
+    int count = std::max(1, parser.value(clients).toInt());
+    int interval = std::max(1, parser.value(delay).toInt());
+
+    qsrand(static_cast<uint>(QDateTime::currentMSecsSinceEpoch()));
+
+    std::vector<std::unique_ptr<Bot>> bots;
+    int running = count;
+    quint64 moves = 0;
+
+    for (int i = 0; i < count; ++i) {
+        bots.emplace_back(new Bot);
+        Bot &bot = *bots.back();
+        bot.player.reset(new Player(nullptr));
+        bot.player->setName(QString("%1 %2").arg(parser.value(name)).arg(i + 1));
+
+        // spread the moves of the bots over the interval
+        bot.timer.setInterval(interval);
+        QObject::connect(&bot.timer, &QTimer::timeout, [&bot, &moves]() {
+            if (play(bot)) {
+                ++moves;
+            } else {
+                bot.timer.stop();
+            }
+        });
+
+        QObject::connect(bot.player.get(), &Player::receivedTeamList, [&bot, &parser, &team](const QStringList &teams) {
+            if (parser.isSet(team) && teams.contains(parser.value(team))) {
+                bot.player->changeTeam(parser.value(team));
+            }
+        });
+
+        QObject::connect(bot.player.get(), &Player::receivedNewBoard,
+                         [&bot, interval](const Cells &given, const Cells &board, GameMode) {
+                             bot.given = fromCells(given);
+                             bot.board = fromCells(board);
+                             Sudoku sudoku;
+                             std::vector<int> puzzle = bot.given;
+                             sudoku.setBoard(puzzle);
+                             bot.solution = sudoku.getSolution();
+                             QTimer::singleShot(qrand() % interval, &bot.timer, SLOT(start()));
+                         });
+
+        QObject::connect(bot.player.get(), &Player::otherPlayerValues, [&bot](const CellChanges &cells) {
+            for (int pos = 0; pos < 81 && static_cast<size_t>(pos) < bot.board.size(); ++pos) {
+                if (cells.has(pos)) {
+                    bot.board[static_cast<size_t>(pos)] = cells.at(pos);
+                }
+            }
+        });
+
+        QObject::connect(bot.player.get(), &Player::gameOverWinner, [&bot](QString) { bot.timer.stop(); });
+
+        QObject::connect(bot.player.get(), &Player::playerConnected, [&bot]() { bot.connected = true; });
+
+        QObject::connect(bot.player.get(), &Player::playerDisconnected, [&bot, &running, &app]() {
+            bot.timer.stop();
+            if (--running == 0) {
+                app.quit();
+            }
+        });
+
+        bot.player->connectToGame(host);
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QTimer report;
+    QObject::connect(&report, &QTimer::timeout, [&]() {
+        long connected = std::count_if(bots.begin(), bots.end(), [](auto &bot) { return bot->connected; });
+        std::printf("%ld/%d bots connected, %llu moves (%.1f moves/s)\n", connected, count,
+                    static_cast<unsigned long long>(moves), moves * 1000.0 / std::max<qint64>(1, elapsed.elapsed()));
+        std::fflush(stdout);
+    });
+    report.start(5000);
+
+    return app.exec();
+}
@@ -0,0 +1,503 @@
+/*
+ * main.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * sudoqu-puzzles: solves, counts the solutions of, grades, canonicalizes or generates
+ * puzzles in bulk, and builds puzzle banks without duplicates. Puzzles are read and
+ * written one per line, 81 characters with '0' or '.' for empty squares. Lines are
+ * processed in batches by one worker per core, through bounded queues, so memory use
+ * does not depend on the size of the input.
+ */
+
+#include "isomorph.h"
+#include "puzzlebank.h"
+#include "solver.h"
+#include "sudoku.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace Sudoqu;
+
+namespace {
+
+/**
+ * @brief puzzles handed to a worker at once
+ */
+const int BATCH_SIZE = 256;
+
+/**
+ * @brief batches waiting in each queue, per worker
+ */
+const int QUEUE_DEPTH = 4;
+
+const int BOARD_SIZE = 81;
+
+enum Mode { SOLVE, COUNT, GRADE, CANONICAL, GENERATE, BANK };
+
+/**
+ * @brief a queue that blocks producers when full, and consumers when empty until it is closed
+ */
+template <typename T> class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {
+    }
+
+    void push(T &&item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+    }
+
+    /**
+     * @return false once the queue is closed and empty
+     */
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
+
+/**
+ * @brief limits how far the reader gets ahead of the writer, so the batches waiting for a slow
+ * one to be written in order cannot pile up
+ */
+class ReadWindow {
+public:
+    explicit ReadWindow(quint64 size) : size(size) {
+    }
+
+    /**
+     * @brief blocks until the batch seq can be read
+     */
+    void wait(quint64 seq) {
+        std::unique_lock<std::mutex> lock(mutex);
+        moved.wait(lock, [this, seq]() { return seq < written + size; });
+    }
+
+    /**
+     * @brief called when the batches before next were written
+     */
+    void advance(quint64 next) {
+        std::lock_guard<std::mutex> lock(mutex);
+        written = next;
+        moved.notify_all();
+    }
+
+private:
+    quint64 size;
+    quint64 written = 0;
+    std::mutex mutex;
+    std::condition_variable moved;
+};
+
+struct Batch {
+    quint64 seq = 0;
+
+    /**
+     * @brief the puzzles read, or the number of puzzles to generate
+     */
+    std::vector<std::string> lines;
+    int generate = 0;
+
+    /**
+     * @brief seeds the board generating this batch, so the output does not depend on the threads
+     */
+    std::uint64_t seed = 0;
+
+    std::string output;
+    std::vector<PuzzleBank::Entry> entries;
+
+    /**
+     * @brief the canonical hash of each entry
+     */
+    std::vector<std::uint64_t> hashes;
+    int processed = 0;
+};
+
+bool parse(const std::string &line, std::vector<int> &puzzle) {
+    if (line.size() < static_cast<size_t>(BOARD_SIZE)) {
+        return false;
+    }
+    puzzle.resize(BOARD_SIZE);
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        char c = line[static_cast<size_t>(pos)];
+        if (c >= '1' && c <= '9') {
+            puzzle[static_cast<size_t>(pos)] = c - '0';
+        } else if (c == '0' || c == '.') {
+            puzzle[static_cast<size_t>(pos)] = 0;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void format(const std::vector<int> &board, std::string &out) {
+    for (int value : board) {
+        out += static_cast<char>(value > 0 ? '0' + value : '.');
+    }
+}
+
+void process(Mode mode, SB::Difficulty difficulty, int givens, Batch &batch) {
+    std::vector<int> puzzle;
+
+    if (mode == GENERATE) {
+        Sudoku sudoku(batch.seed);
+        for (int i = 0; i < batch.generate; ++i) {
+            sudoku.generate(difficulty, givens);
+            format(sudoku.getPuzzle(), batch.output);
+            batch.output += '\n';
+        }
+        batch.processed = batch.generate;
+        return;
+    }
+
+    for (auto &line : batch.lines) {
+        ++batch.processed;
+        std::string key = line.substr(0, BOARD_SIZE);
+
+        if (!parse(line, puzzle)) {
+            if (mode != BANK) {
+                batch.output += key + "\tinvalid\n";
+            }
+            continue;
+        }
+
+        if (mode == CANONICAL) {
+            std::vector<int> canonical = Isomorph::canonical(puzzle);
+            char hash[17];
+            std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(Isomorph::hash(canonical)));
+            batch.output += key + '\t';
+            format(canonical, batch.output);
+            batch.output += '\t' + std::string(hash) + '\n';
+            continue;
+        }
+
+        Solver solver(puzzle);
+        int solutions = solver.countSolutions(mode == SOLVE ? 1 : 2);
+
+        switch (mode) {
+        case SOLVE:
+            batch.output += key + '\t';
+            if (solutions > 0) {
+                format(solver.getSolution(), batch.output);
+            } else {
+                batch.output += "none";
+            }
+            batch.output += '\n';
+            break;
+
+        case COUNT:
+            batch.output += key + '\t' + std::to_string(solutions) + '\n';
+            break;
+
+        case GRADE: {
+            if (solutions != 1) {
+                batch.output += key + (solutions ? "\tnot unique\n" : "\tnone\n");
+                break;
+            }
+            Grader grader(puzzle);
+            Grade grade = grader.grade();
+            batch.output += key + '\t' + std::to_string(grade.rating) + '\t' + techniqueName(grade.hardest) + '\n';
+            break;
+        }
+
+        case BANK: {
+            if (solutions != 1) {
+                break;
+            }
+            Grader grader(puzzle);
+            Grade grade = grader.grade();
+
+            PuzzleBank::Entry entry;
+            entry.puzzle = puzzle;
+            entry.solution = solver.getSolution();
+            entry.rating = grade.rating;
+            entry.hardest = grade.hardest;
+            entry.difficulty = Sudoku::difficulty(grade);
+            batch.entries.push_back(std::move(entry));
+            batch.hashes.push_back(Sudoku::canonicalHash(puzzle));
+            break;
+        }
+
+        case CANONICAL:
+        case GENERATE:
+            break;
+        }
+    }
+}
+
+bool parseDifficulty(const QString &name, SB::Difficulty &difficulty) {
+    const std::map<QString, SB::Difficulty> names = {
+        {"simple", SB::SIMPLE}, {"easy", SB::EASY}, {"intermediate", SB::INTERMEDIATE}, {"expert", SB::EXPERT},
+    };
+    auto it = names.find(name.toLower());
+    if (it == names.end()) {
+        return false;
+    }
+    difficulty = it->second;
+    return true;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sudoqu-puzzles");
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Solves, counts, grades, canonicalizes or generates puzzles in bulk, and builds puzzle banks");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption threads(QStringList() << "j" << "threads", "Use <n> worker threads.", "n",
+                               QString::number(std::max(1, QThread::idealThreadCount())));
+    QCommandLineOption output(QStringList() << "o" << "output", "Write to <file> (required for bank).", "file");
+    QCommandLineOption count(QStringList() << "n" << "count", "Generate <n> puzzles.", "n", "1000");
+    QCommandLineOption difficulty(QStringList() << "d" << "difficulty",
+                                  "Generate puzzles of <level>: simple, easy, intermediate or expert.", "level",
+                                  "easy");
+    QCommandLineOption seed(QStringList() << "s" << "seed", "Generate the same puzzles as another run with <n>.", "n");
+    parser.addOption(threads);
+    parser.addOption(output);
+    parser.addOption(count);
+    parser.addOption(difficulty);
+    QCommandLineOption givens(QStringList() << "g" << "givens", "Generate puzzles with about <n> givens.", "n", "0");
+    parser.addOption(seed);
+    parser.addOption(givens);
+    parser.addPositionalArgument("mode", "solve, count, grade, canonical, generate or bank.");
+    parser.addPositionalArgument("input", "The puzzles, one per line (standard input if omitted).", "[input]");
+    parser.process(app);
+
+    const std::map<QString, Mode> modes = {
+        {"solve", SOLVE},       {"count", COUNT},       {"grade", GRADE},
+        {"canonical", CANONICAL}, {"generate", GENERATE}, {"bank", BANK},
+    };
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty() || args.size() > 2 || modes.find(args.first()) == modes.end()) {
+        parser.showHelp(1);
+    }
+    Mode mode = modes.at(args.first());
+
+    SB::Difficulty level = SB::EASY;
+    if (!parseDifficulty(parser.value(difficulty), level)) {
+        std::fprintf(stderr, "Unknown difficulty %s\n", qPrintable(parser.value(difficulty)));
+        return 1;
+    }
+
+    if (mode == BANK && !parser.isSet(output)) {
+        std::fprintf(stderr, "bank needs an output file (--output)\n");
+        return 1;
+    }
+
+    std::FILE *in = stdin;
+    if (mode != GENERATE && args.size() == 2) {
+        in = std::fopen(qPrintable(args.at(1)), "r");
+        if (in == nullptr) {
+            std::fprintf(stderr, "Could not open %s\n", qPrintable(args.at(1)));
+            return 1;
+        }
+    }
+
+    std::FILE *out = stdout;
+    if (mode != BANK && parser.isSet(output)) {
+        out = std::fopen(qPrintable(parser.value(output)), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "Could not create %s\n", qPrintable(parser.value(output)));
+            return 1;
+        }
+    }
+
+    std::uint64_t base_seed = Random::randomSeed();
+    if (parser.isSet(seed)) {
+        bool ok = false;
+        base_seed = parser.value(seed).toULongLong(&ok);
+        if (!ok) {
+            std::fprintf(stderr, "Invalid seed %s\n", qPrintable(parser.value(seed)));
+            return 1;
+        }
+    } else if (mode == GENERATE) {
+        std::fprintf(stderr, "Generating with --seed %llu\n", static_cast<unsigned long long>(base_seed));
+    }
+
+    int clues = std::max(0, parser.value(givens).toInt());
+    int workers = std::max(1, parser.value(threads).toInt());
+    BoundedQueue<Batch> todo(static_cast<size_t>(workers * QUEUE_DEPTH));
+    BoundedQueue<Batch> done(static_cast<size_t>(workers * QUEUE_DEPTH));
+
+    // room for both queues to stay full while a worker is late with the next batch to write
+    ReadWindow window(static_cast<quint64>(workers * (2 * QUEUE_DEPTH + 1)));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::thread reader([&]() {
+        quint64 seq = 0;
+
+        if (mode == GENERATE) {
+            for (int left = std::max(0, parser.value(count).toInt()); left > 0; left -= BATCH_SIZE) {
+                Batch batch;
+                batch.seq = seq++;
+                window.wait(batch.seq);
+                batch.generate = std::min(left, BATCH_SIZE);
+                batch.seed = base_seed + batch.seq;
+                todo.push(std::move(batch));
+            }
+        } else {
+            char buffer[512];
+            Batch batch;
+            while (std::fgets(buffer, sizeof(buffer), in)) {
+                size_t size = std::strcspn(buffer, "\r\n");
+
+                // the rest of a line longer than the buffer is not another puzzle
+                if (buffer[size] == '\0' && !std::feof(in)) {
+                    char rest[512];
+                    while (std::fgets(rest, sizeof(rest), in) && !std::strchr(rest, '\n')) {
+                    }
+                }
+
+                if (size == 0 || buffer[0] == '#') {
+                    continue;
+                }
+                batch.lines.emplace_back(buffer, size);
+                if (batch.lines.size() == static_cast<size_t>(BATCH_SIZE)) {
+                    batch.seq = seq++;
+                    window.wait(batch.seq);
+                    todo.push(std::move(batch));
+                    batch = Batch();
+                }
+            }
+            if (!batch.lines.empty()) {
+                batch.seq = seq++;
+                window.wait(batch.seq);
+                todo.push(std::move(batch));
+            }
+        }
+        todo.close();
+    });
+
+    std::atomic<int> running(workers);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; ++i) {
+        pool.emplace_back([&]() {
+            Batch batch;
+            while (todo.pop(batch)) {
+                process(mode, level, clues, batch);
+                batch.lines.clear();
+                done.push(std::move(batch));
+            }
+            if (--running == 0) {
+                done.close();
+            }
+        });
+    }
+
+    // batches finish out of order, write them in the order they were read
+    std::map<quint64, Batch> waiting;
+    quint64 next = 0;
+    qint64 processed = 0;
+    PuzzleBankWriter bank;
+    std::unordered_set<std::uint64_t> seen;
+    qint64 duplicates = 0;
+
+    Batch batch;
+    while (done.pop(batch)) {
+        quint64 seq = batch.seq;
+        waiting.emplace(seq, std::move(batch));
+
+        for (auto it = waiting.find(next); it != waiting.end(); it = waiting.find(++next)) {
+            std::fwrite(it->second.output.data(), 1, it->second.output.size(), out);
+            for (size_t i = 0; i < it->second.entries.size(); ++i) {
+                if (seen.insert(it->second.hashes[i]).second) {
+                    bank.add(it->second.entries[i]);
+                } else {
+                    ++duplicates;
+                }
+            }
+            processed += it->second.processed;
+            waiting.erase(it);
+        }
+        window.advance(next);
+    }
+
+    reader.join();
+    for (auto &worker : pool) {
+        worker.join();
+    }
+
+    if (in != stdin) {
+        std::fclose(in);
+    }
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    if (mode == BANK) {
+        if (!bank.save(parser.value(output))) {
+            std::fprintf(stderr, "Could not write %s\n", qPrintable(parser.value(output)));
+            return 1;
+        }
+        std::fprintf(stderr, "%d puzzles with a unique solution written to the bank, %lld duplicates skipped\n",
+                     bank.size(), static_cast<long long>(duplicates));
+    }
+
+    double seconds = std::max<qint64>(1, timer.nsecsElapsed()) / 1e9;
+    std::fprintf(stderr, "%lld puzzles in %.2f s (%.0f puzzles/s, %d threads)\n", static_cast<long long>(processed),
+                 seconds, processed / seconds, workers);
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+QT += core
+QT -= gui
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+TARGET = sudoqu-puzzles
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+SOURCES +=  main.cpp \
+            ../../src/sudoku.cpp \
+            ../../src/solver.cpp \
+            ../../src/grader.cpp \
+            ../../src/units.cpp \
+            ../../src/isomorph.cpp \
+            ../../src/solutioncache.cpp \
+            ../../src/random.cpp \
+            ../../src/generator.cpp \
+            ../../src/puzzlebank.cpp
+
+HEADERS  += ../../src/sudoku.h \
+            ../../src/solver.h \
+            ../../src/grader.h \
+            ../../src/units.h \
+            ../../src/isomorph.h \
+            ../../src/solutioncache.h \
+            ../../src/random.h \
+            ../../src/generator.h \
+            ../../src/puzzlebank.h
+
+VERSION = "0.2.2"
+
+DEFINES += VERSION=\\\"$$VERSION\\\"
+
+CONFIG += link_pkgconfig
+PKGCONFIG += qqwing
@@ -0,0 +1,175 @@
+/*
+ * main.cpp
+ * Copyright (C) 2016  Jason Pleau <jason@jpleau.ca>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * sudoqu-replay: feeds a game recorded by the server back through Sudoqu::Game,
+ * either as fast as possible (to measure the server) or at the players' pace.
+ */
+
+#include "game.h"
+#include "recorder.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QTcpSocket>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+using namespace Sudoqu;
+
+namespace {
+
+/**
+ * @brief turns one recorded event into the messages the player sent
+ */
+void replayEvent(Game &game, Player *player, const Recording::Event &event) {
+    QJsonObject obj;
+
+    switch (event.type) {
+    case RECORDED_JOIN:
+        if (player->getName().isEmpty()) {
+            obj["message"] = SEND_NAME;
+            obj["id"] = player->getId();
+            obj["name"] = event.name;
+            obj["version"] = SUDOQU_VERSION;
+            game.processMessage(player, obj);
+        } else if (player->getName() != event.name) {
+            obj["message"] = CHANGE_NAME;
+            obj["new_name"] = event.name;
+            game.processMessage(player, obj);
+        }
+
+        if (!event.team.isEmpty() && player->getTeam() != event.team) {
+            QJsonObject team;
+            team["message"] = CHANGE_TEAM;
+            team["team"] = event.team;
+            game.processMessage(player, team);
+        }
+        break;
+
+    case RECORDED_VALUE:
+        obj["message"] = NEW_VALUE;
+        obj["pos"] = event.pos;
+        obj["val"] = event.value;
+        game.processMessage(player, obj);
+        break;
+
+    case RECORDED_NOTES: {
+        QJsonArray notes;
+        for (int note : event.notes) {
+            notes.append(note);
+        }
+        obj["message"] = UPDATE_NOTES;
+        obj["pos"] = event.pos;
+        obj["notes"] = notes;
+        game.processMessage(player, obj);
+        break;
+    }
+
+    case RECORDED_FOCUS:
+        obj["message"] = SET_FOCUS;
+        obj["id"] = player->getId();
+        obj["pos"] = event.pos;
+        game.processMessage(player, obj);
+        break;
+    }
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sudoqu-replay");
+    QCoreApplication::setApplicationVersion(VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a game recorded by a Sudoqu server");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption realtime("realtime", "Wait between events as long as the players did.");
+    QCommandLineOption repeat(QStringList() << "r" << "repeat", "Replay the game <n> times.", "n", "1");
+    QCommandLineOption metrics("metrics", "Print the server metrics after the replay.");
+    parser.addOption(realtime);
+    parser.addOption(repeat);
+    parser.addOption(metrics);
+    parser.addPositionalArgument("recording", "The recorded game (.sqr file).");
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    QString path = parser.positionalArguments().first();
+    Recording recording;
+    if (!recording.open(path)) {
+        std::fprintf(stderr, "%s is not a Sudoqu recording\n", qPrintable(path));
+        return 1;
+    }
+
+    int runs = std::max(1, parser.value(repeat).toInt());
+    qint64 replayed = 0;
+
+    QElapsedTimer total;
+    total.start();
+
+    for (int run = 0; run < runs; ++run) {
+        Game game;
+        game.setTeamNames(recording.teams);
+        if (!game.start_game(recording.puzzle, recording.solution, recording.mode)) {
+            std::fprintf(stderr, "%s does not contain a valid puzzle\n", qPrintable(path));
+            return 1;
+        }
+
+        std::map<int, Player *> players;
+
+        QElapsedTimer wall;
+        wall.start();
+
+        for (auto &event : recording.events) {
+            if (parser.isSet(realtime)) {
+                qint64 wait = event.time - wall.elapsed();
+                if (wait > 0) {
+                    QThread::msleep(static_cast<unsigned long>(wait));
+                }
+            }
+
+            Player *&player = players[event.player];
+            if (player == nullptr) {
+                player = game.addPlayer(new QTcpSocket);
+            }
+
+            replayEvent(game, player, event);
+            ++replayed;
+        }
+
+        if (parser.isSet(metrics) && run == runs - 1) {
+            std::printf("%s", qPrintable(game.getMetrics().expose()));
+        }
+    }
+
+    qint64 elapsed = std::max<qint64>(1, total.nsecsElapsed() / 1000);
+    std::printf("%lld events, %d run(s) in %lld us (%.0f events/s)\n", static_cast<long long>(replayed), runs,
+                static_cast<long long>(elapsed), replayed * 1e6 / elapsed);
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+QT += core network
+QT -= gui
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+TARGET = sudoqu-replay
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+SOURCES +=  main.cpp \
+            ../../src/game.cpp \
+            ../../src/sudoku.cpp \
+            ../../src/solver.cpp \
+            ../../src/grader.cpp \
+            ../../src/units.cpp \
+            ../../src/isomorph.cpp \
+            ../../src/solutioncache.cpp \
+            ../../src/random.cpp \
+            ../../src/generator.cpp \
+            ../../src/metrics.cpp \
+            ../../src/journal.cpp \
+            ../../src/recorder.cpp \
+            ../../src/puzzlebank.cpp
+
+HEADERS  += ../../src/game.h \
+            ../../src/sudoku.h \
+            ../../src/solver.h \
+            ../../src/grader.h \
+            ../../src/units.h \
+            ../../src/isomorph.h \
+            ../../src/solutioncache.h \
+            ../../src/random.h \
+            ../../src/generator.h \
+            ../../src/metrics.h \
+            ../../src/journal.h \
+            ../../src/recorder.h \
+            ../../src/puzzlebank.h
+
+LIBS += -L$$OUT_PWD/../../client -lsudoqu-client
+PRE_TARGETDEPS += $$OUT_PWD/../../client/libsudoqu-client.a
+
+VERSION = "0.2.2"
+
+DEFINES += VERSION=\\\"$$VERSION\\\"
+
+CONFIG += link_pkgconfig
+PKGCONFIG += qqwing